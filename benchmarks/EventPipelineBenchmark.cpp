@@ -0,0 +1,372 @@
+/**
+ *  @copyright Copyright 2016 The J-PET Framework Authors. All rights reserved.
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may find a copy of the License in the LICENCE file.
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *  @file EventPipelineBenchmark.cpp
+ *  @brief Measures latency and throughput of reading, decoding and drawing
+ *  events. Results are written as JSON, one object per measurement.
+ */
+
+#include "../src/DataProcessor.h"
+#include "../src/GeometryVisualizator.h"
+#include "../src/StageTimer.h"
+#include <JPetGeomMapping/JPetGeomMapping.h>
+#include <JPetParamManager/JPetParamManager.h>
+#include <TROOT.h>
+#include <algorithm>
+#include <atomic>
+#include <boost/program_options.hpp>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <new>
+#include <random>
+#include <string>
+#include <utility>
+#include <vector>
+
+using namespace jpet_event_display;
+
+namespace
+{
+// Heap allocations of the whole process, prefetcher thread included
+std::atomic<long long> gNumberOfAllocations(0);
+} // namespace
+
+void* operator new(std::size_t size)
+{
+  gNumberOfAllocations++;
+  if (void* memory = std::malloc(size ? size : 1))
+    return memory;
+  throw std::bad_alloc();
+}
+
+void operator delete(void* memory) noexcept
+{
+  std::free(memory);
+}
+
+namespace
+{
+typedef std::chrono::steady_clock Clock;
+
+struct Measurement {
+  std::string name;
+  std::string file;
+  std::string fileType;
+  std::vector<double> latencies; // in microseconds
+  double totalSeconds = 0.;
+  long long allocations = 0; // during timed parts only
+};
+
+struct BenchmarkOptions {
+  std::string geometryFileName = "large_barrel.json";
+  int runNumber = 0;
+  std::vector<std::string> dataFileNames;
+  long long numberOfEvents = 1000; // per measurement
+  unsigned int seed = 12345;
+  std::string outputFileName;
+};
+
+// Geometry and data shared by all measurements
+struct Setup {
+  std::shared_ptr<JPetGeomMapping> mapper;
+  std::shared_ptr<const StripPosTable> stripPositions;
+  int numberOfLayers = 0;
+  std::vector<std::pair<int, double>> layerStats;
+};
+
+const char* getFileTypeName(FileTypes type)
+{
+  switch (type) {
+  case FileTypes::fTimeWindow:
+    return "JPetTimeWindow";
+  case FileTypes::fRawSignal:
+    return "JPetRawSignal";
+  case FileTypes::fHit:
+    return "JPetHit";
+  case FileTypes::fEvent:
+    return "JPetEvent";
+  case FileTypes::fSigCh:
+    return "JPetSigCh";
+  default:
+    return "none";
+  }
+}
+
+double microsecondsSince(const Clock::time_point& start)
+{
+  return std::chrono::duration<double, std::micro>(Clock::now() - start)
+         .count();
+}
+
+// nearest-rank percentile of sorted values
+double percentile(const std::vector<double>& sorted, double fraction)
+{
+  if (sorted.empty())
+    return 0.;
+  size_t rank = static_cast<size_t>(std::ceil(fraction * sorted.size()));
+  return sorted[std::max<size_t>(rank, 1) - 1];
+}
+
+std::string escapeJson(const std::string& text)
+{
+  std::string result;
+  for (char c : text) {
+    if (c == '"' || c == '\\')
+      result += '\\';
+    result += c;
+  }
+  return result;
+}
+
+void writeJson(std::ostream& out, const std::vector<Measurement>& results)
+{
+  out << "[\n";
+  for (size_t i = 0; i < results.size(); i++) {
+    const Measurement& m = results[i];
+    std::vector<double> sorted = m.latencies;
+    std::sort(sorted.begin(), sorted.end());
+    double sum = 0.;
+    for (double latency : sorted)
+      sum += latency;
+    out << "  {\"benchmark\": \"" << escapeJson(m.name) << "\", \"file\": \""
+        << escapeJson(m.file) << "\", \"fileType\": \"" << m.fileType
+        << "\", \"events\": " << sorted.size() << ", \"eventsPerSecond\": "
+        << (m.totalSeconds > 0. ? sorted.size() / m.totalSeconds : 0.)
+        << ", \"meanUs\": " << (sorted.empty() ? 0. : sum / sorted.size())
+        << ", \"p50Us\": " << percentile(sorted, 0.5)
+        << ", \"p99Us\": " << percentile(sorted, 0.99)
+        << ", \"maxUs\": " << (sorted.empty() ? 0. : sorted.back())
+        << ", \"allocationsPerEvent\": "
+        << (sorted.empty() ? 0. : double(m.allocations) / sorted.size()) << "}"
+        << (i + 1 < results.size() ? "," : "") << "\n";
+  }
+  out << "]\n";
+}
+
+long long countEvents(const Setup& setup, const std::string& fileName)
+{
+  DataProcessor processor(setup.mapper, setup.stripPositions);
+  if (!processor.openFile(fileName.c_str()) ||
+      !processor.waitForEventIndex())
+    return 0;
+  return processor.getNumberOfEvents();
+}
+
+/* Events are shown as in the GUI, with frame cache and prefetching, one
+   after another or in random order.
+*/
+Measurement measureNthEvent(const Setup& setup, const std::string& fileName,
+                            const std::vector<long long>& events,
+                            const std::string& name)
+{
+  Measurement result;
+  result.name = name;
+  result.file = fileName;
+  DataProcessor processor(setup.mapper, setup.stripPositions);
+  if (!processor.openFile(fileName.c_str()) ||
+      !processor.waitForEventIndex())
+    return result;
+  long long allocationsBefore = gNumberOfAllocations;
+  Clock::time_point begin = Clock::now();
+  for (long long event : events) {
+    Clock::time_point start = Clock::now();
+    if (processor.nthEvent(event))
+      result.latencies.push_back(microsecondsSince(start));
+  }
+  result.totalSeconds = microsecondsSince(begin) / 1e6;
+  result.allocations = gNumberOfAllocations - allocationsBefore;
+  result.fileType =
+    getFileTypeName(ProcessedData::getInstance().getCurrentFileType());
+  return result;
+}
+
+/* Every event is decoded once with decodeEvent and only its extraction from
+   the time window is timed, by the getDataForCurrentEvent stage of the
+   profiler. Allocations are counted for the whole decodeEvent, so they also
+   include reading of time windows.
+*/
+Measurement measureExtraction(const Setup& setup, const std::string& fileName,
+                              const std::vector<long long>& events)
+{
+  const char* stage = "getDataForCurrentEvent";
+  Measurement result;
+  result.name = stage;
+  result.file = fileName;
+  DataProcessor processor(setup.mapper, setup.stripPositions);
+  processor.setPrefetchingEnabled(false);
+  if (!processor.openFile(fileName.c_str()) ||
+      !processor.waitForEventIndex())
+    return result;
+  Profiler& profiler = Profiler::getInstance();
+  profiler.setEnabled(true);
+  profiler.reset();
+  DisplayFrame frame;
+  for (long long event : events) {
+    double totalBefore = profiler.getTotal(stage);
+    long long allocationsBefore = gNumberOfAllocations;
+    if (!processor.decodeEvent(event, frame))
+      continue;
+    result.allocations += gNumberOfAllocations - allocationsBefore;
+    double latency = (profiler.getTotal(stage) - totalBefore) * 1000.;
+    result.latencies.push_back(latency);
+    result.totalSeconds += latency / 1e6;
+  }
+  profiler.setEnabled(false);
+  result.fileType =
+    getFileTypeName(ProcessedData::getInstance().getCurrentFileType());
+  result.name += "/" + result.fileType;
+  return result;
+}
+
+/* drawData draws only the active view, so each view is measured separately
+   by making it active. Canvases are offscreen, ROOT has to be in batch mode.
+*/
+Measurement measureDrawing(const Setup& setup, const std::string& fileName,
+                           const std::vector<long long>& events,
+                           GeometryVisualizator::View view,
+                           const std::string& viewName)
+{
+  Measurement result;
+  result.name = "drawData/" + viewName;
+  result.file = fileName;
+  DataProcessor processor(setup.mapper, setup.stripPositions);
+  if (!processor.openFile(fileName.c_str()) ||
+      !processor.waitForEventIndex())
+    return result;
+  GeometryVisualizator visualizator(setup.numberOfLayers, 50,
+                                    setup.layerStats);
+  visualizator.createBatchCanvases(800, 800);
+  visualizator.showGeometry();
+  visualizator.setActiveView(view);
+  for (long long event : events) {
+    if (!processor.nthEvent(event))
+      continue;
+    long long allocationsBefore = gNumberOfAllocations;
+    Clock::time_point start = Clock::now();
+    visualizator.drawData();
+    double latency = microsecondsSince(start);
+    result.allocations += gNumberOfAllocations - allocationsBefore;
+    result.latencies.push_back(latency);
+    result.totalSeconds += latency / 1e6;
+  }
+  result.fileType =
+    getFileTypeName(ProcessedData::getInstance().getCurrentFileType());
+  return result;
+}
+
+std::vector<Measurement> runBenchmarks(const Setup& setup,
+                                       const BenchmarkOptions& options)
+{
+  std::vector<Measurement> results;
+  std::mt19937_64 generator(options.seed);
+  for (const std::string& fileName : options.dataFileNames) {
+    long long numberOfEventsInFile = countEvents(setup, fileName);
+    if (numberOfEventsInFile <= 0) {
+      std::cerr << "No events in file: " << fileName << "\n";
+      continue;
+    }
+    long long numberOfEvents =
+      std::min(options.numberOfEvents, numberOfEventsInFile);
+    std::vector<long long> sequential(numberOfEvents);
+    for (long long i = 0; i < numberOfEvents; i++)
+      sequential[i] = i;
+    std::uniform_int_distribution<long long> distribution(
+      0, numberOfEventsInFile - 1);
+    std::vector<long long> random(numberOfEvents);
+    for (long long& event : random)
+      event = distribution(generator);
+
+    std::cerr << "Benchmarking " << fileName << " (" << numberOfEvents
+              << " of " << numberOfEventsInFile << " events)\n";
+    results.push_back(
+      measureNthEvent(setup, fileName, sequential, "nthEvent/sequential"));
+    results.push_back(
+      measureNthEvent(setup, fileName, random, "nthEvent/random"));
+    results.push_back(measureExtraction(setup, fileName, sequential));
+    const std::pair<GeometryVisualizator::View, const char*> views[] = {
+      {GeometryVisualizator::k3dView, "3d"},
+      {GeometryVisualizator::kUnrolledView, "unrolled"},
+      {GeometryVisualizator::kTopView, "top"},
+      {GeometryVisualizator::kDiagramView, "diagram"}
+    };
+    for (const auto& view : views)
+      results.push_back(
+        measureDrawing(setup, fileName, sequential, view.first, view.second));
+  }
+  return results;
+}
+} // namespace
+
+int main(int argc, char** argv)
+{
+  namespace po = boost::program_options;
+  BenchmarkOptions options;
+  try {
+    po::options_description desc("Allowed options");
+    desc.add_options()("help,h", "produce help message")(
+      "input,i", po::value(&options.geometryFileName), "Input file")(
+        "run,r", po::value(&options.runNumber), "run number of input file")(
+          "data,d",
+          po::value(&options.dataFileNames)->multitoken()->required(),
+          "data files to benchmark")(
+            "events,n", po::value(&options.numberOfEvents),
+            "events read in each measurement")(
+              "seed", po::value(&options.seed), "seed of random seeks")(
+                "out,o", po::value(&options.outputFileName),
+                "JSON file with results (default standard output)");
+    po::variables_map vm;
+    po::store(po::parse_command_line(argc, argv, desc), vm);
+    if (vm.count("help")) {
+      std::cout << desc << "\n";
+      return 1;
+    }
+    po::notify(vm);
+  } catch (std::exception& e) {
+    std::cerr << e.what() << "\n";
+    return 1;
+  }
+
+  ROOT::EnableThreadSafety();
+  gROOT->SetBatch(kTRUE);
+
+  JPetParamManager paramManager(
+    new JPetParamGetterAscii(options.geometryFileName));
+  paramManager.fillParameterBank(options.runNumber);
+  auto bank = paramManager.getParamBank();
+  Setup setup;
+  setup.mapper = std::make_shared<JPetGeomMapping>(bank);
+  setup.stripPositions = std::make_shared<const StripPosTable>(*setup.mapper,
+                         bank);
+  std::vector<size_t> layersSize = setup.mapper->getLayersSizes();
+  setup.numberOfLayers = layersSize.size() - 1; // last layer is reference
+  for (int i = 0; i < setup.numberOfLayers; i++) {
+    setup.layerStats.push_back(
+      std::make_pair(layersSize[i], setup.mapper->getRadiusOfLayer(i + 1)));
+  }
+
+  std::vector<Measurement> results = runBenchmarks(setup, options);
+  if (options.outputFileName.empty()) {
+    writeJson(std::cout, results);
+  } else {
+    std::ofstream out(options.outputFileName.c_str());
+    writeJson(out, results);
+    if (!out) {
+      std::cerr << "Could not write results to " << options.outputFileName
+                << "\n";
+      return 1;
+    }
+  }
+  return results.empty() ? 1 : 0;
+}
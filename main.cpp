@@ -12,12 +12,19 @@
  *
  */
 
+#include "src/BatchRenderer.h"
+#include "src/DisplayCache.h"
 #include "src/EventDisplay.h"
+#include "src/FileChain.h"
+#include "src/PointAccumulator.h"
+#include "src/StageTimer.h"
 #include <JPetGeomMapping/JPetGeomMapping.h>
 #include <JPetParamManager/JPetParamManager.h>
+#include <TROOT.h>
 #include <TRint.h>
 #include <boost/program_options.hpp>
 #include <iostream>
+#include <stdexcept>
 
 int main(int argc, char** argv)
 {
@@ -26,12 +33,58 @@ int main(int argc, char** argv)
 
   std::string inFile = "large_barrel.json";
   int runNumber = 0;
+  size_t frameCacheSize = 64;
+  bool batchMode = false;
+  BatchOptions batchOptions;
+  std::string eventRange;
+  std::string formats = "png";
+  std::string followPath;
+  double followRefreshRate = 5.0;
+  std::string convertPattern;
+  bool profile = false;
+  std::string traceFileName;
+  size_t accumulationCapacity = PointAccumulator::kDefaultCapacity;
+  double accumulationCellSize = 0.;
 
   try {
     po::options_description desc("Allowed options");
     desc.add_options()("help,h", "produce help message")(
       "input,i", po::value(&inFile), "Input file")(
-        "run,r", po::value(&runNumber), "run number of input file");
+        "run,r", po::value(&runNumber), "run number of input file")(
+          "cache,c", po::value(&frameCacheSize),
+          "memory for decoded events cache in MB")(
+            "follow,F", po::value(&followPath),
+            "follow growing data file or directory with new data files")(
+              "refresh-rate", po::value(&followRefreshRate),
+              "how many times per second followed data is checked")(
+                "convert", po::value(&convertPattern),
+                "write display cache next to data files (also list or "
+                "pattern) and exit")(
+                  "profile", po::bool_switch(&profile),
+                  "measure time of reading, extraction and drawing stages")(
+                    "trace", po::value(&traceFileName),
+                    "write measured intervals to Chrome trace (.json) or "
+                    "CSV (.csv) file at exit")(
+                      "saved-markers", po::value(&accumulationCapacity),
+                      "maximum number of markers saved between events on "
+                      "each view")(
+                        "saved-markers-cell", po::value(&accumulationCellSize),
+                        "size in cm of grid cell holding at most one saved "
+                        "marker (0 - no decimation)");
+    po::options_description batchDesc("Batch mode options");
+    batchDesc.add_options()("batch,b", po::bool_switch(&batchMode),
+                            "render events to files without GUI")(
+                              "data,d", po::value(&batchOptions.dataFileName),
+                              "data file with time windows")(
+                                "events,e", po::value(&eventRange),
+                                "events to render, n or first-last")(
+                                  "out,o", po::value(&batchOptions.outputDirectory),
+                                  "output directory")(
+                                    "format,f", po::value(&formats),
+                                    "comma separated image formats, e.g. png,svg")(
+                                      "jobs,j", po::value(&batchOptions.numberOfJobs),
+                                      "number of worker processes");
+    desc.add(batchDesc);
     po::variables_map vm;
     po::store(po::parse_command_line(argc, argv, desc), vm);
     po::notify(vm);
@@ -39,6 +92,17 @@ int main(int argc, char** argv)
       std::cout << desc << "\n";
       return 1;
     }
+    if (batchMode) {
+      if (batchOptions.dataFileName.empty())
+        throw std::invalid_argument("batch mode requires --data file");
+      if (!eventRange.empty() &&
+          !BatchRenderer::parseEventRange(eventRange, batchOptions.firstEvent,
+                                          batchOptions.lastEvent))
+        throw std::invalid_argument("bad event range: " + eventRange);
+      batchOptions.formats = BatchRenderer::parseFormats(formats);
+      if (batchOptions.formats.empty())
+        throw std::invalid_argument("no output format given");
+    }
   } catch (std::exception& e) {
     std::cout << e.what() << "\n";
     return 1;
@@ -49,6 +113,11 @@ int main(int argc, char** argv)
             << ", please wait, application will start soon... "
             << "\n";
 
+  // events are counted on a background thread while the GUI is running
+  ROOT::EnableThreadSafety();
+  if (batchMode)
+    gROOT->SetBatch(kTRUE);
+
   JPetParamManager fparamManagerInstance(new JPetParamGetterAscii(inFile));
   fparamManagerInstance.fillParameterBank(runNumber);
   auto bank = fparamManagerInstance.getParamBank();
@@ -63,7 +132,42 @@ int main(int argc, char** argv)
     layersInfo.push_back(
       std::make_pair(layersSize[i], fMapper->getRadiusOfLayer(i + 1)));
   }
+  if (!convertPattern.empty()) {
+    int exitCode = 0;
+    for (const std::string& dataFile :
+         FileChain::expandFileNames(convertPattern)) {
+      std::string cacheFile = display_cache::getCacheFileName(dataFile);
+      DisplayCacheReader existing;
+      if (existing.open(cacheFile) && existing.matchesDataFile(dataFile)) {
+        std::cout << cacheFile << " is up to date\n";
+        continue;
+      }
+      existing.close();
+      DataProcessor processor(fMapper, bank);
+      processor.setPrefetchingEnabled(false); // events are decoded in order
+      std::cout << "Converting " << dataFile << " to " << cacheFile << "\n";
+      if (!processor.openFile(dataFile.c_str()) ||
+          !DisplayCacheWriter::convert(processor, cacheFile, dataFile))
+        exitCode = 1;
+    }
+    return exitCode;
+  }
+  if (batchMode) {
+    BatchRenderer renderer(fMapper, bank, numberOfLayers, 50, layersInfo,
+                           batchOptions);
+    Profiler::getInstance().setEnabled(profile || !traceFileName.empty());
+    Profiler::getInstance().setTracing(!traceFileName.empty());
+    int exitCode = renderer.run();
+    if (!traceFileName.empty())
+      Profiler::getInstance().dumpTrace(traceFileName);
+    return exitCode;
+  }
   EventDisplay myDisplay;
-  myDisplay.run(fMapper, numberOfLayers, 50, layersInfo);
+  myDisplay.setProfiling(profile, traceFileName);
+  myDisplay.setAccumulation(accumulationCapacity, accumulationCellSize);
+  if (!followPath.empty())
+    myDisplay.setFollow(followPath, followRefreshRate);
+  myDisplay.run(fMapper, bank, numberOfLayers, 50, layersInfo,
+                frameCacheSize);
   return 0;
 }
@@ -0,0 +1,195 @@
+/**
+ *  @copyright Copyright 2016 The J-PET Framework Authors. All rights reserved.
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may find a copy of the License in the LICENCE file.
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *  @file BatchRenderer.cpp
+ */
+
+#include "./BatchRenderer.h"
+#include "./FileChain.h"
+#include "./GeometryVisualizator.h"
+#include "./StageTimer.h"
+#include <JPetLoggerInclude.h>
+#include <TROOT.h>
+#include <TSystem.h>
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <sstream>
+#include <sys/wait.h>
+#include <unistd.h>
+
+namespace jpet_event_display
+{
+
+BatchRenderer::BatchRenderer(
+  std::shared_ptr<JPetGeomMapping> mapper, const JPetParamBank& bank,
+  const int numberOfLayers, const int scintillatorLenght,
+  const std::vector<std::pair<int, double>>& layerStats,
+  const BatchOptions& options)
+  : fMapper(mapper),
+    fStripPositions(std::make_shared<const StripPosTable>(*mapper, bank)),
+    fNumberOfLayers(numberOfLayers), fScintillatorLenght(scintillatorLenght),
+    fLayerStats(layerStats), fOptions(options),
+    fDataFileNames(FileChain::expandFileNames(options.dataFileName))
+{
+  if (fOptions.numberOfJobs == 0)
+    fOptions.numberOfJobs = 1;
+}
+
+// accepts "n" or "first-last", both ends are included
+bool BatchRenderer::parseEventRange(const std::string& range, long long& first,
+                                    long long& last)
+{
+  std::istringstream in(range);
+  char separator = 0;
+  if (!(in >> first) || first < 0)
+    return false;
+  if (!(in >> separator)) {
+    last = first;
+    return true;
+  }
+  if (separator != '-' || !(in >> last) || last < first)
+    return false;
+  return in.eof() || (in >> std::ws).eof();
+}
+
+// comma separated list of image formats, e.g. "png,svg"
+std::vector<std::string> BatchRenderer::parseFormats(const std::string& formats)
+{
+  std::vector<std::string> result;
+  std::istringstream in(formats);
+  std::string format;
+  while (std::getline(in, format, ',')) {
+    if (!format.empty())
+      result.push_back(format);
+  }
+  return result;
+}
+
+/* Event index is built (and saved next to the data file) once, before
+   workers are started, so each of them only loads it.
+*/
+bool BatchRenderer::countEvents(long long& numberOfEvents)
+{
+  DataProcessor processor(fMapper, fStripPositions);
+  processor.setPrefetchingEnabled(false); // no event is shown
+  if (!processor.openFiles(fDataFileNames)) {
+    ERROR("Could not open data file: " + fOptions.dataFileName);
+    return false;
+  }
+  bool result = processor.waitForEventIndex();
+  numberOfEvents = processor.getNumberOfEvents();
+  processor.closeFile();
+  return result;
+}
+
+std::string BatchRenderer::getFilePrefix(long long eventNumber) const
+{
+  char name[64];
+  snprintf(name, sizeof(name), "/event_%08lld", eventNumber);
+  return fOptions.outputDirectory + name;
+}
+
+bool BatchRenderer::renderRange(long long first, long long last)
+{
+  DataProcessor processor(fMapper, fStripPositions);
+  // every event is shown only once and in order, so nothing is cached or
+  // prefetched, forked workers do not start threads of their own
+  processor.setFrameCacheSize(0);
+  processor.setPrefetchingEnabled(false);
+  if (!processor.openFiles(fDataFileNames))
+    return false;
+  // indices are saved by countEvents, files which failed are counted again
+  processor.waitForEventIndex();
+  GeometryVisualizator visualizator(fNumberOfLayers, fScintillatorLenght,
+                                    fLayerStats);
+  visualizator.createBatchCanvases(fOptions.canvasWidth,
+                                   fOptions.canvasHeight);
+  visualizator.showGeometry();
+  bool result = true;
+  for (long long i = first; i <= last; i++) {
+    if (!processor.nthEvent(i)) {
+      ERROR("Could not read event " + std::to_string(i));
+      result = false;
+      continue;
+    }
+    visualizator.drawData();
+    visualizator.saveCanvases(getFilePrefix(i), fOptions.formats);
+  }
+  processor.closeFile();
+  // every worker process prints timing of its own events
+  if (Profiler::getInstance().isEnabled()) {
+    std::cout << "Timing of events " << first << "-" << last << ":\n";
+    Profiler::getInstance().printSummary(std::cout);
+  }
+  return result;
+}
+
+int BatchRenderer::run()
+{
+  if (!gROOT->IsBatch())
+    WARNING("ROOT is not in batch mode, canvases will be shown on screen");
+  long long numberOfEvents = 0;
+  if (!countEvents(numberOfEvents))
+    return 1;
+  long long first = fOptions.firstEvent;
+  long long last = fOptions.lastEvent;
+  if (last < 0 || last >= numberOfEvents)
+    last = numberOfEvents - 1;
+  if (first > last) {
+    ERROR("No events to render in given range");
+    return 1;
+  }
+  if (gSystem->mkdir(fOptions.outputDirectory.c_str(), kTRUE) != 0 &&
+      gSystem->AccessPathName(fOptions.outputDirectory.c_str())) {
+    ERROR("Could not create output directory: " + fOptions.outputDirectory);
+    return 1;
+  }
+
+  long long numberOfEventsToRender = last - first + 1;
+  long long numberOfJobs = std::min<long long>(fOptions.numberOfJobs,
+                           numberOfEventsToRender);
+  std::cout << "Rendering events " << first << "-" << last << " with "
+            << numberOfJobs << " job(s) to " << fOptions.outputDirectory
+            << "\n";
+  if (numberOfJobs == 1)
+    return renderRange(first, last) ? 0 : 1;
+
+  std::vector<pid_t> workers;
+  int exitCode = 0;
+  long long chunk = (numberOfEventsToRender + numberOfJobs - 1) / numberOfJobs;
+  for (long long begin = first; begin <= last; begin += chunk) {
+    long long end = std::min(begin + chunk - 1, last);
+    pid_t pid = fork();
+    if (pid < 0) {
+      ERROR("Could not start worker process");
+      exitCode = 1;
+      break;
+    }
+    if (pid == 0) {
+      bool result = renderRange(begin, end);
+      std::cout.flush();
+      std::fflush(nullptr);
+      _exit(result ? 0 : 1); // parent owns ROOT cleanup
+    }
+    workers.push_back(pid);
+  }
+  for (pid_t pid : workers) {
+    int status = 0;
+    if (waitpid(pid, &status, 0) < 0 || !WIFEXITED(status) ||
+        WEXITSTATUS(status) != 0)
+      exitCode = 1;
+  }
+  return exitCode;
+}
+} // namespace jpet_event_display
@@ -0,0 +1,77 @@
+/**
+ *  @copyright Copyright 2016 The J-PET Framework Authors. All rights reserved.
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may find a copy of the License in the LICENCE file.
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *  @brief Renders views of selected events to image files without GUI.
+ */
+
+#ifndef BATCHRENDERER_H
+#define BATCHRENDERER_H
+
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "DataProcessor.h"
+
+namespace jpet_event_display
+{
+struct BatchOptions {
+  std::string dataFileName; // also list or pattern, see FileChain
+  long long firstEvent = 0;
+  long long lastEvent = -1; // -1 means last event in file
+  std::string outputDirectory = ".";
+  std::vector<std::string> formats {"png"};
+  unsigned int numberOfJobs = 1;
+  unsigned int canvasWidth = 800;
+  unsigned int canvasHeight = 800;
+};
+
+/* Event range is split into contiguous parts rendered by separate worker
+   processes. ROOT graphics is not thread safe, so each worker has its own
+   process with its own reader, GeometryVisualizator and offscreen canvases.
+   Requires ROOT to be in batch mode.
+*/
+class BatchRenderer
+{
+public:
+  BatchRenderer(std::shared_ptr<JPetGeomMapping> mapper,
+                const JPetParamBank& bank, const int numberOfLayers,
+                const int scintillatorLenght,
+                const std::vector<std::pair<int, double>>& layerStats,
+                const BatchOptions& options);
+
+  int run();
+
+  static bool parseEventRange(const std::string& range, long long& first,
+                              long long& last);
+  static std::vector<std::string> parseFormats(const std::string& formats);
+
+private:
+  BatchRenderer(const BatchRenderer&) = delete;
+  BatchRenderer& operator=(const BatchRenderer&) = delete;
+
+  bool countEvents(long long& numberOfEvents);
+  bool renderRange(long long first, long long last);
+  std::string getFilePrefix(long long eventNumber) const;
+
+  std::shared_ptr<JPetGeomMapping> fMapper;
+  std::shared_ptr<const StripPosTable> fStripPositions;
+  int fNumberOfLayers = 0;
+  int fScintillatorLenght = 0;
+  std::vector<std::pair<int, double>> fLayerStats;
+  BatchOptions fOptions;
+  std::vector<std::string> fDataFileNames;
+};
+} // namespace jpet_event_display
+
+#endif /*  !BATCHRENDERER_H */
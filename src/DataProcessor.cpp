@@ -13,241 +13,339 @@
  */
 
 #include "./DataProcessor.h"
+#include "./DisplayCache.h"
+#include "./EventPrefetcher.h"
+#include "./FileChain.h"
+#include "./FrameCache.h"
+#include "./OccupancyScanner.h"
+#include "./StageTimer.h"
+#include <TSystem.h>
+#include <ctime>
 #include <iostream>
 #include <limits>
 
 namespace jpet_event_display
 {
 
-DataProcessor::DataProcessor(std::shared_ptr< JPetGeomMapping > mapper)
+DataProcessor::DataProcessor(std::shared_ptr< JPetGeomMapping > mapper,
+                             const JPetParamBank& bank)
+  : DataProcessor(mapper, std::make_shared< const StripPosTable >(*mapper, bank))
+{
+}
+
+DataProcessor::DataProcessor(
+  std::shared_ptr< JPetGeomMapping > mapper,
+  std::shared_ptr< const StripPosTable > stripPositions)
+  : fFrameCache(new FrameCache())
 {
   fMapper = mapper;
+  fStripPositions = stripPositions;
+}
+
+DataProcessor::~DataProcessor()
+{
+  stopOccupancyScan();
+  stopPrefetching();
+  stopEventIndexBuilding();
 }
 
 void DataProcessor::getDataForCurrentEvent()
 {
-  ProcessedData::getInstance().clearData();
-  static std::map< std::string, int > compareMap;
-  if (compareMap.empty()) {
-    compareMap["JPetTimeWindow"] = FileTypes::fTimeWindow;
-    compareMap["JPetRawSignal"] = FileTypes::fRawSignal;
-    compareMap["JPetHit"] = FileTypes::fHit;
-    compareMap["JPetEvent"] = FileTypes::fEvent;
-    compareMap["JPetSigCh"] = FileTypes::fSigCh;
+  getDataForCurrentEvent(ProcessedData::getInstance());
+}
+
+void DataProcessor::getDataForCurrentEvent(DisplayFrame& frame)
+{
+  ScopedTimer timer("getDataForCurrentEvent");
+  frame.clearData();
+  frame.setCurrentFileType(fFileType);
+  if (!fExtractEvent) {
+    frame.addToInfo("Not implemented object type");
+    return;
   }
-  auto fCurrentTimeWindow =
-    dynamic_cast<JPetTimeWindow&>(fReader.getCurrentEntry());
+  const JPetTimeWindow& fCurrentTimeWindow =
+    dynamic_cast<const JPetTimeWindow&>(fReader.getCurrentEntry());
 
   if (fCurrentTimeWindow.getNumberOfEvents() <= 0) {
     ERROR("No events in time window");
     return;
   }
-  const char* branchName = fCurrentTimeWindow[0].GetName();
-  ProcessedData::getInstance().setCurrentFileType(
-    static_cast< FileTypes >(compareMap[branchName]));
+  (this->*fExtractEvent)(fCurrentTimeWindow, frame);
+}
+
+/* Steps of extraction are timed once per event here, helpers called for
+   every hit or signal are not timed.
+*/
+template <>
+void DataProcessor::extractEvent<JPetSigCh>(const JPetTimeWindow& timeWindow,
+    DisplayFrame& frame)
+{
+  {
+    ScopedTimer timer("getActiveScintillators");
+    getActiveScintillators(timeWindow.getEvent< JPetSigCh >(
+                             fNumberOfEventInCurrentTimeWindow), frame);
+  }
+  if (fRequiredData & kInfoData) {
+    ScopedTimer timer("currentActivedScintillatorsInfo");
+    frame.addToInfo(currentActivedScintillatorsInfo(frame));
+  }
+}
+
+template <>
+void DataProcessor::extractEvent<JPetRawSignal>(
+  const JPetTimeWindow& timeWindow, DisplayFrame& frame)
+{
+  const JPetRawSignal& rawSignal = timeWindow.getEvent< JPetRawSignal >(
+                                     fNumberOfEventInCurrentTimeWindow);
+  {
+    ScopedTimer timer("getActiveScintillators");
+    getActiveScintillators(rawSignal, frame);
+  }
+  if (fRequiredData & kDiagramData) {
+    ScopedTimer timer("getDataForDiagram");
+    getDataForDiagram(rawSignal, frame);
+  }
+  if (fRequiredData & kInfoData) {
+    ScopedTimer timer("currentActivedScintillatorsInfo");
+    frame.addToInfo(currentActivedScintillatorsInfo(frame));
+  }
+}
+
+template <>
+void DataProcessor::extractEvent<JPetHit>(const JPetTimeWindow& timeWindow,
+    DisplayFrame& frame)
+{
+  const JPetHit& hit =
+    timeWindow.getEvent< JPetHit >(fNumberOfEventInCurrentTimeWindow);
+  {
+    ScopedTimer timer("getActiveScintillators");
+    getActiveScintillators(hit, frame);
+  }
+  if (fRequiredData & kDiagramData) {
+    ScopedTimer timer("getDataForDiagram");
+    getDataForDiagram(hit, frame);
+  }
+  if (fRequiredData & kInfoData) {
+    ScopedTimer timer("getHitsInfo");
+    getHitsInfo(hit, frame);
+  }
+  if (fRequiredData & kHitData) {
+    ScopedTimer timer("getHitsPosition");
+    getHitsPosition(hit, frame);
+  }
+}
+
+template <>
+void DataProcessor::extractEvent<JPetEvent>(const JPetTimeWindow& timeWindow,
+    DisplayFrame& frame)
+{
+  const JPetEvent& event =
+    timeWindow.getEvent< JPetEvent >(fNumberOfEventInCurrentTimeWindow);
+  {
+    ScopedTimer timer("getActiveScintillators");
+    getActiveScintillators(event, frame);
+  }
+  if (fRequiredData & kDiagramData) {
+    ScopedTimer timer("getDataForDiagram");
+    getDataForDiagram(event, frame);
+  }
+  if (fRequiredData & kInfoData) {
+    ScopedTimer timer("getHitsInfo");
+    getHitsInfo(event, frame);
+  }
+  if (fRequiredData & kHitData) {
+    ScopedTimer timer("getHitsPosition");
+    getHitsPosition(event, frame);
+  }
+}
 
-  switch (ProcessedData::getInstance().getCurrentFileType()) {
+/* All objects stored in time windows of a file have the same type, so it is
+   checked once, on the first non-empty time window, and extraction function
+   for this type is used for every event.
+*/
+void DataProcessor::detectFileType()
+{
+  fFileType = FileTypes::fNone;
+  fExtractEvent = nullptr;
+  for (long long i = 0; i < fReader.getNbOfAllEntries(); i++) {
+    if (!fReader.nthEntry(i))
+      break;
+    const JPetTimeWindow& timeWindow =
+      dynamic_cast<const JPetTimeWindow&>(fReader.getCurrentEntry());
+    if (timeWindow.getNumberOfEvents() <= 0)
+      continue;
+    fFileType = getFileType(timeWindow[0].GetName());
+    break;
+  }
+  switch (fFileType) {
   case FileTypes::fSigCh:
-    getActiveScintillators(fCurrentTimeWindow.getEvent< JPetSigCh >(
-                             fNumberOfEventInCurrentTimeWindow));
-    ProcessedData::getInstance().addToInfo(currentActivedScintillatorsInfo());
+    fExtractEvent = &DataProcessor::extractEvent< JPetSigCh >;
     break;
   case FileTypes::fRawSignal:
-    getActiveScintillators(fCurrentTimeWindow.getEvent< JPetRawSignal >(
-                             fNumberOfEventInCurrentTimeWindow));
-    getDataForDiagram(fCurrentTimeWindow.getEvent< JPetRawSignal >(
-                        fNumberOfEventInCurrentTimeWindow));
-    ProcessedData::getInstance().addToInfo(currentActivedScintillatorsInfo());
+    fExtractEvent = &DataProcessor::extractEvent< JPetRawSignal >;
     break;
   case FileTypes::fHit:
-    getActiveScintillators(fCurrentTimeWindow.getEvent< JPetHit >(
-                             fNumberOfEventInCurrentTimeWindow));
-    getDataForDiagram(fCurrentTimeWindow.getEvent< JPetHit >(
-                        fNumberOfEventInCurrentTimeWindow));
-    getHitsPosition(fCurrentTimeWindow.getEvent< JPetHit >(
-                      fNumberOfEventInCurrentTimeWindow));
+    fExtractEvent = &DataProcessor::extractEvent< JPetHit >;
     break;
   case FileTypes::fEvent:
-    getActiveScintillators(fCurrentTimeWindow.getEvent< JPetEvent >(
-                             fNumberOfEventInCurrentTimeWindow));
-    getDataForDiagram(fCurrentTimeWindow.getEvent< JPetEvent >(
-                        fNumberOfEventInCurrentTimeWindow));
-    getHitsPosition(fCurrentTimeWindow.getEvent< JPetEvent >(
-                      fNumberOfEventInCurrentTimeWindow));
+    fExtractEvent = &DataProcessor::extractEvent< JPetEvent >;
     break;
   default:
-    ProcessedData::getInstance().addToInfo("Not implemented object type");
-    return;
+    WARNING("Not implemented object type in file");
     break;
   }
 }
 
-std::string DataProcessor::currentActivedScintillatorsInfo()
+FileTypes DataProcessor::getFileType(const std::string& className)
+{
+  static const std::map< std::string, FileTypes > compareMap = {
+    {"JPetTimeWindow", FileTypes::fTimeWindow},
+    {"JPetRawSignal", FileTypes::fRawSignal},
+    {"JPetHit", FileTypes::fHit},
+    {"JPetEvent", FileTypes::fEvent},
+    {"JPetSigCh", FileTypes::fSigCh}
+  };
+  auto fileType = compareMap.find(className);
+  return fileType != compareMap.end() ? fileType->second : FileTypes::fNone;
+}
+
+std::string DataProcessor::currentActivedScintillatorsInfo(DisplayFrame& frame)
 {
-  std::map< int, std::map< size_t, int > > info;
   std::ostringstream oss;
-  for (auto iter =
-         ProcessedData::getInstance().getActivedScintilators().begin();
-       iter != ProcessedData::getInstance().getActivedScintilators().end();
-       ++iter) {
-    int layer = iter->first;
-    const std::vector< size_t >& strips = iter->second;
-    for (auto stripIter = strips.begin(); stripIter != strips.end();
-         ++stripIter) {
-      size_t scin = *stripIter;
-      info[layer][scin] = info[layer][scin] + 1;
-    }
-  }
-  for (auto it = info.begin(); it != info.end(); it++) {
-    for (auto itScin = it->second.begin(); itScin != it->second.end(); itScin++) {
-      oss << "layer " << it->first << " scin " << itScin->first
-          << " no of events " << itScin->second << "\n";
-    }
+  for (const auto& strip : frame.getActivedScintilators()) {
+    oss << "layer " << strip.layer << " scin " << strip.slot
+        << " no of events " << strip.hits << "\n";
   }
   return oss.str();
 }
 
-void DataProcessor::addToSelectionIfNotPresent(ScintillatorsInLayers& selection,
-    StripPos& pos)
+void DataProcessor::addToSelection(ScintillatorsInLayers& selection,
+                                   const StripPos& pos)
 {
-  if (selection.find(pos.layer) != selection.end()) {
-    if (std::find(selection[pos.layer].begin(), selection[pos.layer].end(),
-                  pos.slot) == selection[pos.layer].end())
-      selection[pos.layer].push_back(pos.slot);
-  } else {
-    selection[pos.layer] = {pos.slot};
-  }
+  if (StripPosTable::isValid(pos))
+    selection.add(pos.layer, pos.slot);
 }
 
-void DataProcessor::getActiveScintillators(const JPetSigCh& sigCh)
+void DataProcessor::getActiveScintillators(const JPetSigCh& sigCh,
+    DisplayFrame& frame)
 {
-  ScintillatorsInLayers selection;
-  auto PM = sigCh.getPM();
-  if (PM.isNullObject()) {
-    return;
-  }
-  auto scin = PM.getScin();
-  if (scin.isNullObject()) {
-    return;
-  }
-  auto barrel = scin.getBarrelSlot();
-  if (barrel.isNullObject()) {
-    return;
-  }
-  StripPos pos = fMapper->getStripPos(barrel);
-
-  addToSelectionIfNotPresent(selection, pos);
-  ProcessedData::getInstance().addActivedScins(selection);
+  addToSelection(frame.getActivedScintilators(),
+                             fStripPositions->getStripPos(sigCh.getPM()));
 }
 
-void DataProcessor::getActiveScintillators(const JPetRawSignal& rawSignal)
+void DataProcessor::getActiveScintillators(const JPetRawSignal& rawSignal,
+    DisplayFrame& frame)
 {
-  auto leadingSigCh = rawSignal.getPoints(JPetSigCh::Leading);
-  auto trailingSigCh = rawSignal.getPoints(JPetSigCh::Trailing);
-  ScintillatorsInLayers selection;
-  for (const auto& channel : leadingSigCh) {
-    auto PM = channel.getPM();
-    if (PM.isNullObject()) {
-      continue;
-    }
-    auto scin = PM.getScin();
-    if (scin.isNullObject()) {
-      continue;
-    }
-    auto barrel = scin.getBarrelSlot();
-    if (barrel.isNullObject()) {
-      continue;
+  // getPoints returns sorted copy of points, so each edge is taken only once
+  const JPetSigCh::EdgeType edges[] = {JPetSigCh::Leading, JPetSigCh::Trailing};
+  for (JPetSigCh::EdgeType edge : edges) {
+    for (const JPetSigCh& channel : rawSignal.getPoints(edge)) {
+      addToSelection(frame.getActivedScintilators(),
+                                 fStripPositions->getStripPos(channel.getPM()));
     }
-    StripPos pos = fMapper->getStripPos(barrel);
+  }
+}
+
+void DataProcessor::getActiveScintillators(const JPetHit& hitSignal,
+    DisplayFrame& frame)
+{
+  addToSelection(frame.getActivedScintilators(),
+                             fStripPositions->getStripPos(hitSignal.getBarrelSlot()));
+}
 
-    addToSelectionIfNotPresent(selection, pos);
+void DataProcessor::getActiveScintillators(const JPetEvent& event,
+    DisplayFrame& frame)
+{
+  for (const JPetHit& hit : event.getHits()) {
+    addToSelection(frame.getActivedScintilators(),
+                               fStripPositions->getStripPos(hit.getBarrelSlot()));
   }
+}
 
-  for (const auto& channel : trailingSigCh) {
-    auto PM = channel.getPM();
-    if (PM.isNullObject()) {
-      continue;
-    }
-    auto scin = PM.getScin();
-    if (scin.isNullObject()) {
+unsigned int DataProcessor::fillDiagram(
+  const std::vector<JPetSigCh>& leadingPoints,
+  const std::vector<JPetSigCh>& trailingPoints, bool resetLeadingEdge,
+  SignalDiagram& diagram)
+{
+  diagram.numberOfPoints = 0;
+  if (leadingPoints.empty())
+    return trailingPoints.size();
+  unsigned int dropped = 0;
+  float startPos = leadingPoints.front().getValue();
+  // thresholds are numbered from 1
+  float diff[SignalDiagram::kMaxThresholds + 1] = {};
+  for (const JPetSigCh& point : leadingPoints) {
+    int threshold = point.getThresholdNumber();
+    if (threshold < 1 || threshold > SignalDiagram::kMaxThresholds ||
+        !diagram.addPoint({threshold, point.getThreshold(),
+                           resetLeadingEdge ? 0.f : point.getValue(),
+                           JPetSigCh::Leading})) {
+      dropped++;
       continue;
     }
-    auto barrel = scin.getBarrelSlot();
-    if (barrel.isNullObject()) {
+    diff[threshold] = point.getValue() - startPos;
+  }
+  for (const JPetSigCh& point : trailingPoints) {
+    int threshold = point.getThresholdNumber();
+    if (threshold < 1 || threshold > SignalDiagram::kMaxThresholds) {
+      dropped++;
       continue;
     }
-    StripPos pos = fMapper->getStripPos(barrel);
-
-    addToSelectionIfNotPresent(selection, pos);
+    float time = resetLeadingEdge
+                 ? point.getValue() - diff[threshold] - startPos
+                 : point.getValue();
+    if (!diagram.addPoint({threshold, point.getThreshold(), time,
+                           JPetSigCh::Trailing}))
+      dropped++;
   }
-
-  ProcessedData::getInstance().addActivedScins(selection);
-}
-
-void DataProcessor::getActiveScintillators(const JPetHit& hitSignal)
-{
-  ScintillatorsInLayers selection;
-  StripPos pos = fMapper->getStripPos(hitSignal.getBarrelSlot());
-  selection[pos.layer] = {pos.slot};
-
-  ProcessedData::getInstance().addActivedScins(selection);
+  return dropped;
 }
 
-void DataProcessor::getActiveScintillators(const JPetEvent& event)
+bool DataProcessor::getDataForDiagram(const JPetRawSignal& rawSignal,
+                                      SignalDiagram& diagram)
 {
-  ScintillatorsInLayers selection;
-  for (JPetHit hit : event.getHits()) {
-    StripPos pos = fMapper->getStripPos(hit.getBarrelSlot());
-    addToSelectionIfNotPresent(selection, pos);
+  // getPoints returns a copy, so each edge is taken only once
+  const std::vector<JPetSigCh> leadingPoints =
+    rawSignal.getPoints(JPetSigCh::Leading);
+  if (leadingPoints.empty())
+    return false;
+  const JPetPM& PM = leadingPoints[0].getPM();
+  const StripPos& pos = fStripPositions->getStripPos(PM);
+  // both edges of a raw signal come from the same photomultiplier
+  diagram.side = PM.getSide();
+  diagram.layer = pos.layer;
+  diagram.slot = pos.slot;
+  unsigned int dropped = fillDiagram(leadingPoints,
+                                     rawSignal.getPoints(JPetSigCh::Trailing),
+                                     fResetLeadingEdge, diagram);
+  if (dropped > 0) {
+    static std::once_flag warned;
+    std::call_once(warned, []() {
+      WARNING("Signals have thresholds out of 1.." +
+              std::to_string(SignalDiagram::kMaxThresholds) +
+              ", these points are not shown in diagrams");
+    });
   }
-
-  ProcessedData::getInstance().addActivedScins(selection);
+  return !diagram.empty();
 }
 
-DiagramDataMap DataProcessor::getDataForDiagram(const JPetRawSignal& rawSignal,
-    bool)
+// diagram is built directly in the frame, signals without points are dropped
+void DataProcessor::addDiagram(const JPetRawSignal& rawSignal,
+                               SignalDiagrams& diagrams)
 {
-  DiagramDataMap diagramData;
-  StripPos pos = fMapper->getStripPos(
-                   rawSignal.getPoints(JPetSigCh::Leading)[0].getPM().getBarrelSlot());
-  auto data = rawSignal.getTimesVsThresholdValue(JPetSigCh::Leading);
-  float startPos = data.begin()->second.second;
-  float diff[4];
-  float time = 0.f;
-  for (auto it = data.begin(); it != data.end(); it++) {
-    diff[it->first] = it->second.second - startPos;
-    if (!fResetLeadingEdge)
-      time = it->second.second;
-    else
-      time = 0.f;
-    diagramData.push_back(std::make_tuple(
-                            it->first, it->second.first, time, JPetSigCh::Leading,
-                            rawSignal.getPoints(JPetSigCh::Leading)[0].getPM().getSide(), pos.layer,
-                            pos.slot));
-  }
-  auto tmp = rawSignal.getTimesVsThresholdValue(JPetSigCh::Trailing);
-  for (auto it = tmp.begin(); it != tmp.end(); it++) {
-    if (!fResetLeadingEdge)
-      time = it->second.second;
-    else
-      time = it->second.second - diff[it->first] - startPos;
-
-    diagramData.push_back(std::make_tuple(
-                            it->first, it->second.first, time, JPetSigCh::Trailing,
-                            rawSignal.getPoints(JPetSigCh::Trailing)[0].getPM().getSide(), pos.layer,
-                            pos.slot));
-  }
-  return diagramData;
+  diagrams.emplace_back();
+  if (!getDataForDiagram(rawSignal, diagrams.back()))
+    diagrams.pop_back();
 }
 
-void DataProcessor::getDataForDiagram(const JPetRawSignal& rawSignal)
+void DataProcessor::getDataForDiagram(const JPetRawSignal& rawSignal,
+                                      DisplayFrame& frame)
 {
-  DiagramDataMapVector diagramDataVector;
-  diagramDataVector.push_back(getDataForDiagram(rawSignal, true));
-  ProcessedData::getInstance().addDiagram(diagramDataVector);
+  addDiagram(rawSignal, frame.getDiagramData());
 }
 
-void DataProcessor::addToInfoFromStripPos(const StripPos& pos, const JPetHit& hit)
+void DataProcessor::addToInfoFromStripPos(const StripPos& pos, const JPetHit& hit,
+    DisplayFrame& frame)
 {
   double r =
     sqrt(hit.getPosX() * hit.getPosX() + hit.getPosY() * hit.getPosY());
@@ -260,81 +358,568 @@ void DataProcessor::addToInfoFromStripPos(const StripPos& pos, const JPetHit& hi
       << " z: " << hit.getPosZ() << "\n"
       << " time: " << hit.getTime() << "\n"
       << "r: " << r << " theta: " << (fi * 180.0) / M_PI << "\n";
-  ProcessedData::getInstance().addToInfo(oss.str());
+  frame.addToInfo(oss.str());
 }
 
-void DataProcessor::getDataForDiagram(const JPetHit& hitSignal)
+void DataProcessor::getDataForDiagram(const JPetHit& hitSignal,
+                                      DisplayFrame& frame)
 {
-  DiagramDataMapVector diagramDataVector;
-  diagramDataVector.push_back(getDataForDiagram(
-                                hitSignal.getSignalA().getRecoSignal().getRawSignal(), true));
-  diagramDataVector.push_back(getDataForDiagram(
-                                hitSignal.getSignalB().getRecoSignal().getRawSignal(), true));
-  ProcessedData::getInstance().addDiagram(diagramDataVector);
+  SignalDiagrams& diagrams = frame.getDiagramData();
+  diagrams.reserve(diagrams.size() + 2);
+  addDiagram(hitSignal.getSignalA().getRecoSignal().getRawSignal(), diagrams);
+  addDiagram(hitSignal.getSignalB().getRecoSignal().getRawSignal(), diagrams);
+}
 
-  StripPos pos = fMapper->getStripPos(hitSignal.getSignalA()
-                                      .getRecoSignal()
-                                      .getRawSignal()
-                                      .getPoints(JPetSigCh::Leading)[0]
-                                      .getPM()
-                                      .getBarrelSlot());
+void DataProcessor::getDataForDiagram(const JPetEvent& event,
+                                      DisplayFrame& frame)
+{
+  const std::vector<JPetHit>& hits = event.getHits();
+  SignalDiagrams& diagrams = frame.getDiagramData();
+  diagrams.reserve(diagrams.size() + 2 * hits.size());
+  for (const JPetHit& hit : hits) {
+    addDiagram(hit.getSignalA().getRecoSignal().getRawSignal(), diagrams);
+    addDiagram(hit.getSignalB().getRecoSignal().getRawSignal(), diagrams);
+  }
+}
 
-  addToInfoFromStripPos(pos, hitSignal);
+void DataProcessor::getHitsInfo(const JPetHit& hitSignal, DisplayFrame& frame)
+{
+  // hit is assigned to the same barrel slot as its signals
+  const StripPos& pos =
+    fStripPositions->getStripPos(hitSignal.getBarrelSlot());
+  addToInfoFromStripPos(pos, hitSignal, frame);
 }
 
-void DataProcessor::getDataForDiagram(const JPetEvent& event)
+void DataProcessor::getHitsInfo(const JPetEvent& event, DisplayFrame& frame)
 {
-  DiagramDataMapVector diagramDataVector;
-  if (event.getHits().size() < 1)
-    return;
-  for (JPetHit hit : event.getHits()) {
-    diagramDataVector.push_back(getDataForDiagram(
-                                  hit.getSignalA().getRecoSignal().getRawSignal(), true));
-    diagramDataVector.push_back(getDataForDiagram(
-                                  hit.getSignalB().getRecoSignal().getRawSignal(), true));
+  for (const JPetHit& hit : event.getHits())
+    getHitsInfo(hit, frame);
+}
 
-    StripPos pos = fMapper->getStripPos(hit.getSignalA()
-                                        .getRecoSignal()
-                                        .getRawSignal()
-                                        .getPoints(JPetSigCh::Leading)[0]
-                                        .getPM()
-                                        .getBarrelSlot());
-    // calculate position in (r, fi) domain from (x,y)
+void DataProcessor::getHitsPosition(const JPetHit& hitSignal,
+                                    DisplayFrame& frame)
+{
+  frame.getHits().push_back(hitSignal.getPos());
+  frame.getHitTimes().push_back(hitSignal.getTime());
+}
 
-    addToInfoFromStripPos(pos, hit);
+void DataProcessor::getHitsPosition(const JPetEvent& event,
+                                    DisplayFrame& frame)
+{
+  const std::vector<JPetHit>& hits = event.getHits();
+  HitPositions& hitsPos = frame.getHits();
+  HitTimes& hitTimes = frame.getHitTimes();
+  hitsPos.reserve(hitsPos.size() + hits.size());
+  hitTimes.reserve(hitTimes.size() + hits.size());
+  for (const JPetHit& hit : hits) {
+    hitsPos.push_back(hit.getPos());
+    hitTimes.push_back(hit.getTime());
   }
-  ProcessedData::getInstance().addDiagram(diagramDataVector);
 }
 
-void DataProcessor::getHitsPosition(const JPetHit& hitSignal)
+bool DataProcessor::openReader(const char* filename)
 {
-  HitPositions hitsPos;
-  hitsPos.push_back(hitSignal.getPos());
-  ProcessedData::getInstance().addHits(hitsPos);
+  fDisplayCache.reset();
+  fNumberOfEventsInFile = 0;
+  fEventIndexReady = false;
+  fEventIndex.clear();
+  fScannedIndex.clear();
+  fFileName = filename;
+  bool openFileResult = fReader.openFileAndLoadData(filename);
+  fParamBank = openFileResult ? getParamBank(filename) : nullptr;
+  if (openFileResult) {
+    detectFileType();
+    selectBranches();
+  }
+  return openFileResult;
 }
 
-void DataProcessor::getHitsPosition(const JPetEvent& event)
+/* ParamBank has to be in memory to resolve references to detector objects
+   stored in events. It is read once per file and shared by all processors
+   which have the file open, e.g. by prefetching and occupancy threads.
+*/
+std::shared_ptr<JPetParamBank> DataProcessor::getParamBank(
+  const std::string& filename)
 {
-  HitPositions hitsPos;
-  for (JPetHit hit : event.getHits()) {
-    hitsPos.push_back(hit.getPos());
+  static std::mutex mutex;
+  static std::map<std::string, std::weak_ptr<JPetParamBank>> loaded;
+  std::lock_guard<std::mutex> lock(mutex);
+  std::shared_ptr<JPetParamBank> bank = loaded[filename].lock();
+  if (!bank) {
+    bank = std::shared_ptr<JPetParamBank>(dynamic_cast<JPetParamBank*>(
+                                            fReader.getObjectFromFile("ParamBank")));
+    loaded[filename] = bank;
   }
-  ProcessedData::getInstance().addHits(hitsPos);
+  return bank;
+}
+
+/* Signals are the biggest part of hits and are needed only for diagrams,
+   so without diagrams their branches are not read.
+*/
+void DataProcessor::selectBranches()
+{
+  fReader.skipMembers(getSkippedMembers(fFileType, fRequiredData));
+}
+
+std::vector<std::string> DataProcessor::getSkippedMembers(
+  FileTypes fileType, unsigned int requiredData)
+{
+  std::vector<std::string> skippedMembers;
+  if (!(requiredData & kDiagramData) &&
+      (fileType == FileTypes::fHit || fileType == FileTypes::fEvent))
+    skippedMembers = {"fSignalA", "fSignalB"};
+  return skippedMembers;
+}
+
+/* Frames decoded before with less data are dropped. Prefetcher is not
+   restarted, it only drops its frames and reads the required branches too.
+*/
+void DataProcessor::setRequiredData(unsigned int data)
+{
+  if (data == fRequiredData)
+    return;
+  bool moreData = (data & ~fRequiredData) != 0;
+  fRequiredData = data;
+  if (!fDisplayCache && fReader.getTree())
+    selectBranches();
+  if (moreData)
+    fFrameCache->clear();
+  if (fPrefetcher)
+    fPrefetcher->setRequiredData(data);
 }
 
 bool DataProcessor::openFile(const char* filename)
 {
-  fNumberOfEventsInFile = 0;
-  bool openFileResult = fReader.openFileAndLoadData(filename);
-  dynamic_cast< JPetParamBank* >(fReader.getObjectFromFile(
-                                   "ParamBank")); // just read param bank, no need to save it to variable
+  stopOccupancyScan();
+  stopPrefetching();
+  stopEventIndexBuilding();
+  fFollowing = false;
+  fFollowedDirectory.clear();
+  fChain.reset();
+  fFrameCache->clear();
+  if (openDisplayCache(filename))
+    return true;
+  if (!openReader(filename))
+    return false;
+  if (fEventIndex.load(filename, fReader.getNbOfAllEntries())) {
+    fEventIndexReady = true;
+    fNumberOfEventsInFile = fEventIndex.getNumberOfEvents();
+    startPrefetching();
+  } else {
+    // number of events is unknown until the index is built in background
+    fNumberOfEventsInFile = std::numeric_limits<long long>::max();
+    startEventIndexBuilding(filename);
+  }
+  return true;
+}
+
+/* Display cache is used instead of the data file if it is given directly
+   or if the cache next to the data file was made from its current version.
+*/
+bool DataProcessor::openDisplayCache(const std::string& filename)
+{
+  fDisplayCache.reset();
+  const std::string extension = ".evdc";
+  bool isCacheFile = filename.size() > extension.size() &&
+                     filename.compare(filename.size() - extension.size(),
+                                      extension.size(), extension) == 0;
+  std::string cacheFileName =
+    isCacheFile ? filename : display_cache::getCacheFileName(filename);
+  if (!isCacheFile && gSystem->AccessPathName(cacheFileName.c_str()))
+    return false;
+  std::unique_ptr<DisplayCacheReader> cache(new DisplayCacheReader());
+  if (!cache->open(cacheFileName))
+    return false;
+  if (!isCacheFile && !cache->matchesDataFile(filename)) {
+    INFO("Display cache is older than data file, not used: " + cacheFileName);
+    return false;
+  }
+  fReader.closeFile();
+  fFileName = filename;
+  fFileType = cache->getFileType();
+  fExtractEvent = nullptr;
+  fEventIndex.clear();
+  fEventIndexReady = true;
+  fNumberOfEventsInFile = cache->getNumberOfEvents();
+  fDisplayCache = std::move(cache);
+  return true;
+}
+
+// Used by helper processors (e.g. prefetching) working on already indexed file
+bool DataProcessor::openFile(const char* filename, const EventIndex& index)
+{
+  if (!openReader(filename))
+    return false;
+  fEventIndex = index;
+  fEventIndexReady = true;
+  fNumberOfEventsInFile = fEventIndex.getNumberOfEvents();
+  return true;
+}
+
+/* Files are shown as one dataset. None of them is opened here, a file is
+   opened when an event from it is shown for the first time.
+*/
+bool DataProcessor::openFiles(const std::vector<std::string>& filenames)
+{
+  if (filenames.size() == 1)
+    return openFile(filenames[0].c_str());
+  stopOccupancyScan();
+  stopPrefetching();
+  stopEventIndexBuilding();
+  fFollowing = false;
+  fFollowedDirectory.clear();
+  fDisplayCache.reset();
+  fChain.reset();
+  if (filenames.empty())
+    return false;
+  fFrameCache->clear();
+  fChain = std::unique_ptr<FileChain>(new FileChain(filenames));
+  fChainCounted = false;
+  fCurrentFileInChain = -1;
   fNumberOfEventsInFile = std::numeric_limits<long long>::max();
-  return openFileResult;
+  if (!updateEventIndex()) // all files could have saved indices
+    fChain->startCounting();
+  return true;
+}
+
+// number of events in the dataset is kept, event index is the one of file
+// as in openFile, an up-to-date display cache is used instead of the file
+bool DataProcessor::openFileInChain(size_t file)
+{
+  stopPrefetching();
+  const std::string filename = fChain->getFileName(file);
+  long long numberOfEvents = fNumberOfEventsInFile; // of the whole chain
+  bool result = openDisplayCache(filename) || openReader(filename.c_str());
+  fNumberOfEventsInFile = numberOfEvents;
+  if (!result) {
+    ERROR("Could not open file: " + filename);
+    fCurrentFileInChain = -1;
+    return false;
+  }
+  fEventIndex = fChain->getIndex(file);
+  fEventIndexReady = true;
+  fCurrentFileInChain = file;
+  startPrefetching();
+  return true;
 }
 
 void DataProcessor::closeFile()
 {
+  stopOccupancyScan();
+  stopPrefetching();
+  stopEventIndexBuilding();
+  fFollowing = false;
+  fFollowedDirectory.clear();
+  fDisplayCache.reset();
+  fChain.reset();
+  fCurrentFileInChain = -1;
   fReader.closeFile();
+  fParamBank.reset();
+}
+
+void DataProcessor::setResetLeadingEdge(bool reset)
+{
+  if (reset == fResetLeadingEdge)
+    return;
+  fResetLeadingEdge = reset;
+  fFrameCache->clear();
+  if (fPrefetcher) { // already prefetched frames were made with old setting
+    stopPrefetching();
+    startPrefetching();
+  }
+}
+
+void DataProcessor::setFrameCacheSize(size_t megabytes)
+{
+  fFrameCache->setMemoryBudget(megabytes * 1024 * 1024);
+}
+
+void DataProcessor::startPrefetching()
+{
+  /* in follow mode the newest event is shown, there is nothing to prefetch,
+     display cache is read faster than prefetcher would decode events */
+  if (!fPrefetchingEnabled || !fEventIndexReady || fFileName.empty() ||
+      fFollowing || fDisplayCache)
+    return;
+  fPrefetcher = std::unique_ptr<EventPrefetcher>(new EventPrefetcher(
+                  fMapper, fStripPositions, fFileName, fEventIndex,
+                  fResetLeadingEdge, fRequiredData));
+}
+
+void DataProcessor::stopPrefetching()
+{
+  fPrefetcher.reset();
+}
+
+void DataProcessor::setPrefetchingEnabled(bool enabled)
+{
+  fPrefetchingEnabled = enabled;
+  if (enabled)
+    startPrefetching();
+  else
+    stopPrefetching();
+}
+
+/* Follow mode, like tail -f. Path can be a data file which is still being
+   written, or a directory where new data files appear. Event index grows
+   with the file, updateFollowed should be called periodically.
+*/
+bool DataProcessor::follow(const char* path)
+{
+  stopOccupancyScan();
+  stopPrefetching();
+  stopEventIndexBuilding();
+  fDisplayCache.reset();
+  fChain.reset();
+  FileStat_t stat;
+  if (gSystem->GetPathInfo(path, stat) != 0) {
+    ERROR(std::string("Path to follow does not exist: ") + path);
+    return false;
+  }
+  if (R_ISDIR(stat.fMode)) {
+    fFollowedDirectory = path;
+    fFollowing = true;
+    // nothing is shown from the previous file until the first one appears
+    fReader.closeFile();
+    fFileName.clear();
+    fEventIndex.clear();
+    fNumberOfEventsInFile = 0;
+    fFrameCache->clear();
+    fFollowedDirectoryTime = 0;
+    fFollowedDirectoryListingTime = 0;
+    fNewestFollowedFile.clear();
+    if (followedDirectoryChanged())
+      fNewestFollowedFile = findNewestFile(fFollowedDirectory);
+    if (!fNewestFollowedFile.empty())
+      openFollowedFile(fNewestFollowedFile);
+    return true;
+  }
+  fFollowedDirectory.clear();
+  if (!openFollowedFile(path)) {
+    fFollowing = false;
+    return false;
+  }
+  return true;
+}
+
+/* Reads only entries appended since the last call, file is not reopened.
+   In directory mode switches to the newest file when it appears. Returns
+   true if there are new events to show.
+*/
+bool DataProcessor::updateFollowed()
+{
+  if (!fFollowing)
+    return false;
+  if (!fFollowedDirectory.empty()) {
+    if (followedDirectoryChanged())
+      fNewestFollowedFile = findNewestFile(fFollowedDirectory);
+    if (!fNewestFollowedFile.empty() && fNewestFollowedFile != fFileName)
+      return openFollowedFile(fNewestFollowedFile) && fNumberOfEventsInFile > 0;
+  }
+  if (fFileName.empty())
+    return false;
+  long long numberOfEvents = fNumberOfEventsInFile;
+  // entries written before the file was opened are counted in background
+  if (!fEventIndexReady && !updateEventIndex())
+    return false;
+  long long numberOfEntries = fReader.refresh();
+  if (numberOfEntries > fEventIndex.getNumberOfEntries()) {
+    appendNewEntries(numberOfEntries);
+    if (!fExtractEvent)
+      detectFileType();
+  }
+  return fNumberOfEventsInFile > numberOfEvents;
+}
+
+void DataProcessor::stopFollowing()
+{
+  if (!fFollowing)
+    return;
+  fFollowing = false;
+  fFollowedDirectory.clear();
+  startPrefetching();
+}
+
+/* Without a saved index entries already in the file are counted by the
+   background index builder, so opening a long file does not block the GUI.
+   Nothing is shown until they are counted.
+*/
+bool DataProcessor::openFollowedFile(const std::string& filename)
+{
+  stopPrefetching();
+  stopEventIndexBuilding();
+  fFollowing = true;
+  fFrameCache->clear();
+  if (!openReader(filename.c_str())) {
+    fFileName.clear(); // tried again on next update, file can be incomplete
+    return false;
+  }
+  if (fEventIndex.load(filename, fReader.getNbOfAllEntries())) {
+    fEventIndexReady = true;
+    appendNewEntries(fReader.getNbOfAllEntries());
+  } else {
+    fNumberOfEventsInFile = 0;
+    startEventIndexBuilding(filename);
+  }
+  return true;
+}
+
+void DataProcessor::appendNewEntries(long long numberOfEntries)
+{
+  for (long long i = fEventIndex.getNumberOfEntries(); i < numberOfEntries;
+       i++) {
+    if (!fReader.nthEntry(i))
+      break;
+    fEventIndex.addEntry(dynamic_cast<JPetTimeWindow&>(fReader.getCurrentEntry())
+                         .getNumberOfEvents());
+  }
+  fNumberOfEventsInFile = fEventIndex.getNumberOfEvents();
+}
+
+/* Directory is listed again only when its modification time changed, i.e.
+   a file was created, removed or renamed in it. The time has a resolution of
+   seconds, so a directory modified in the second of the last listing is
+   listed again on next call.
+*/
+bool DataProcessor::followedDirectoryChanged()
+{
+  FileStat_t stat;
+  if (gSystem->GetPathInfo(fFollowedDirectory.c_str(), stat) != 0)
+    return false;
+  if (stat.fMtime == fFollowedDirectoryTime &&
+      fFollowedDirectoryTime < fFollowedDirectoryListingTime)
+    return false;
+  fFollowedDirectoryTime = stat.fMtime;
+  fFollowedDirectoryListingTime = std::time(nullptr);
+  return true;
+}
+
+// newest ROOT file by modification time, ties are resolved by name
+std::string DataProcessor::findNewestFile(const std::string& directory)
+{
+  void* dir = gSystem->OpenDirectory(directory.c_str());
+  if (!dir)
+    return "";
+  std::string newest;
+  Long_t newestTime = 0;
+  while (const char* entry = gSystem->GetDirEntry(dir)) {
+    std::string name = entry;
+    const std::string extension = ".root";
+    if (name.size() <= extension.size() ||
+        name.compare(name.size() - extension.size(), extension.size(),
+                     extension) != 0)
+      continue;
+    std::string path = directory + "/" + name;
+    FileStat_t stat;
+    if (gSystem->GetPathInfo(path.c_str(), stat) != 0 || R_ISDIR(stat.fMode))
+      continue;
+    if (newest.empty() || stat.fMtime > newestTime ||
+        (stat.fMtime == newestTime && path > newest)) {
+      newest = path;
+      newestTime = stat.fMtime;
+    }
+  }
+  gSystem->FreeDirectory(dir);
+  return newest;
+}
+
+// occupancy of the whole file needs the event index to split events
+bool DataProcessor::startOccupancyScan(unsigned int numberOfThreads)
+{
+  stopOccupancyScan();
+  if (fChain) {
+    WARNING("Occupancy of a chain of files is not supported");
+    return false;
+  }
+  if (fDisplayCache) {
+    WARNING("Occupancy needs the data file, display cache is opened");
+    return false;
+  }
+  if (!fEventIndexReady || fFileName.empty())
+    return false;
+  fOccupancyScanner = std::unique_ptr<OccupancyScanner>(new OccupancyScanner(
+                        fMapper, fStripPositions, fFileName, fEventIndex,
+                        numberOfThreads));
+  return true;
+}
+
+void DataProcessor::stopOccupancyScan()
+{
+  fOccupancyScanner.reset();
+}
+
+void DataProcessor::startEventIndexBuilding(const std::string& filename)
+{
+  INFO("Counting events in background, event index will be saved in " +
+       EventIndex::getIndexFileName(filename));
+  fStopEventIndexBuilding = false;
+  fBuiltEventIndexAvailable = false;
+  fEventIndexThread = std::thread([this, filename]() {
+    EventIndex index;
+    if (index.buildFromEventCounts(filename, fStopEventIndexBuilding)) {
+      index.save(filename);
+    } else if (fStopEventIndexBuilding) {
+      return;
+    } else {
+      // file is shown as empty, otherwise it would stay counted forever
+      ERROR("Could not count events in file: " + filename);
+      index.clear();
+    }
+    std::lock_guard<std::mutex> lock(fEventIndexMutex);
+    fBuiltEventIndex = index;
+    fBuiltEventIndexAvailable = true;
+  });
+}
+
+void DataProcessor::stopEventIndexBuilding()
+{
+  fStopEventIndexBuilding = true;
+  if (fEventIndexThread.joinable())
+    fEventIndexThread.join();
+  fBuiltEventIndexAvailable = false;
+}
+
+/* Takes the index built by background thread if it is ready. Should be
+   called periodically from the GUI thread, returns true when number of
+   events in file has just become known.
+*/
+bool DataProcessor::updateEventIndex()
+{
+  if (fChain) {
+    if (fChainCounted || !fChain->isComplete())
+      return false;
+    fChainCounted = true;
+    fNumberOfEventsInFile = fChain->getNumberOfEvents();
+    return true;
+  }
+  if (fEventIndexReady || !fBuiltEventIndexAvailable)
+    return false;
+  {
+    std::lock_guard<std::mutex> lock(fEventIndexMutex);
+    fEventIndex = fBuiltEventIndex;
+    fBuiltEventIndexAvailable = false;
+  }
+  if (fEventIndexThread.joinable())
+    fEventIndexThread.join();
+  fEventIndexReady = true;
+  fNumberOfEventsInFile = fEventIndex.getNumberOfEvents();
+  startPrefetching();
+  return true;
+}
+
+// Blocks until the background counting is finished, used without GUI
+bool DataProcessor::waitForEventIndex()
+{
+  if (fChain) {
+    fChain->waitForCounting();
+    updateEventIndex();
+    return fChainCounted;
+  }
+  if (fEventIndexReady)
+    return true;
+  if (fEventIndexThread.joinable())
+    fEventIndexThread.join();
+  return updateEventIndex();
 }
 
 bool DataProcessor::nextEvent()
@@ -352,27 +937,87 @@ bool DataProcessor::lastEvent()
   return fReader.lastEntry();
 }
 
+/* Used only until event index is built. Entries are scanned once, number of
+   events of every scanned entry is kept, so next search resumes where the
+   previous one ended instead of reading the file from the beginning.
+*/
+bool DataProcessor::findEventByScanning(long long n, long long& entry,
+                                        unsigned int& eventInEntry)
+{
+  if (fScannedIndex.findEvent(n, entry, eventInEntry))
+    return true;
+  for (long long i = fScannedIndex.getNumberOfEntries();
+       i < fReader.getNbOfAllEntries(); i++) {
+    if (!fReader.nthEntry(i))
+      return false;
+    fScannedIndex.addEntry(dynamic_cast<JPetTimeWindow&>(
+                             fReader.getCurrentEntry()).getNumberOfEvents());
+    if (fScannedIndex.findEvent(n, entry, eventInEntry))
+      return true;
+  }
+  return false;
+}
+
 bool DataProcessor::nthEvent(long long n)
 {
-  long long currentEventToFind = n;
-  if (n < fNumberOfEventsInFile) {
-    for (long long i = 0; i < fReader.getNbOfAllEntries(); i++) {
-      fReader.nthEntry(i);
-      unsigned int numberOfEventsInTimeWindow =
-        dynamic_cast<JPetTimeWindow&>(fReader.getCurrentEntry())
-        .getNumberOfEvents();
-      if (currentEventToFind < numberOfEventsInTimeWindow) {
-        fNumberOfEventInCurrentTimeWindow = currentEventToFind;
-        bool returnValue = fReader.nthEntry(i);
-        getDataForCurrentEvent();
-        return returnValue;
-      } else {
-        currentEventToFind -= numberOfEventsInTimeWindow;
-      }
-    }
-    ERROR("Could not find event in file");
+  ScopedTimer timer("nthEvent");
+  updateEventIndex();
+  if (n >= fNumberOfEventsInFile)
     return false;
-  } else
+  // in a chain n is global event number, files use their own numbers
+  size_t file = 0;
+  long long eventInFile = n;
+  if (fChain) {
+    FileChain::FindResult found = fChain->findEvent(n, file, eventInFile);
+    if (found == FileChain::kNotCountedYet)
+      INFO("Events are still being counted, event " + std::to_string(n) +
+           " is not available yet");
+    if (found != FileChain::kFound)
+      return false;
+  }
+  bool inCurrentFile =
+    !fChain || static_cast<long long>(file) == fCurrentFileInChain;
+  DisplayFrame frame;
+  bool returnValue = true;
+  if (!fFrameCache->get(n, frame)) {
+    if (!inCurrentFile)
+      returnValue = inCurrentFile = openFileInChain(file);
+    if (returnValue &&
+        (!fPrefetcher || !fPrefetcher->takeFrame(eventInFile, frame)))
+      returnValue = decodeEvent(eventInFile, frame);
+    if (returnValue)
+      fFrameCache->put(n, frame);
+  }
+  if (returnValue)
+    ProcessedData::getInstance().setFrame(std::move(frame));
+  if (fPrefetcher && inCurrentFile)
+    fPrefetcher->request(eventInFile + fPrefetchStep, fPrefetchStep,
+                         kNumberOfPrefetchedEvents);
+  return returnValue;
+}
+
+bool DataProcessor::decodeEvent(long long n, DisplayFrame& frame)
+{
+  if (fDisplayCache) {
+    ScopedTimer timer("readDisplayCache");
+    return fDisplayCache->readFrame(n, frame, fResetLeadingEdge);
+  }
+  long long entry = 0;
+  unsigned int eventInEntry = 0;
+  bool found = fEventIndexReady
+               ? fEventIndex.findEvent(n, entry, eventInEntry)
+               : findEventByScanning(n, entry, eventInEntry);
+  if (!found) {
+    ERROR("Could not find event in file");
     return false;
+  }
+  fNumberOfEventInCurrentTimeWindow = eventInEntry;
+  if (fReader.getCurrentEntryNumber() != entry) {
+    ScopedTimer timer("readEntry");
+    if (!fReader.nthEntry(entry))
+      return false;
+  }
+  getDataForCurrentEvent(frame);
+  return true;
 }
 }
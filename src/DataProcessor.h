@@ -15,10 +15,13 @@
 #ifndef DATAPROCESSOR_H
 #define DATAPROCESSOR_H
 
+#include <atomic>
 #include <map>
 #include <memory>
+#include <mutex>
 #include <sstream>
 #include <string>
+#include <thread>
 #include <vector>
 
 #ifndef __CINT__
@@ -42,6 +45,11 @@
 #include <TNamed.h>
 #include <TVector3.h>
 
+#include "EventIndex.h"
+#include "EventReader.h"
+#include "ScintillatorsInLayers.h"
+#include "StripPosTable.h"
+
 namespace jpet_event_display
 {
 enum FileTypes {
@@ -53,53 +61,88 @@ enum FileTypes {
   fSigCh
 };
 
-typedef std::map<size_t, std::vector<size_t>>
-    ScintillatorsInLayers; // layer, scinID, hitPos
-typedef std::vector<std::tuple<int, float, float, JPetSigCh::EdgeType,
-        JPetPM::Side, size_t, size_t>>
-        DiagramDataMap; // threshold number, thresholdValue, time, EdgeType, Side,
-// layer, scin
-typedef std::vector<DiagramDataMap> DiagramDataMapVector;
-typedef std::vector<TVector3> HitPositions;
+// parts of a frame, each view draws only some of them
+enum FrameData {
+  kStripData = 1,
+  kDiagramData = 2,
+  kHitData = 4,
+  kInfoData = 8, // text description shown next to the views
+  kAllData = kStripData | kDiagramData | kHitData | kInfoData
+};
 
-class ProcessedData
+// single threshold crossing of a raw signal
+struct DiagramPoint
 {
-public:
-  ProcessedData(const ProcessedData&) = delete;
-  ProcessedData& operator=(const ProcessedData&) = delete;
-  ~ProcessedData() {}
+  int thresholdNumber;
+  float thresholdValue;
+  float time;
+  JPetSigCh::EdgeType edge;
+};
 
-  static inline ProcessedData& getInstance()
+/* Diagram of one raw signal. A signal has at most kMaxThresholds thresholds
+   on each edge, so points are stored inline and a frame is filled without
+   allocating memory per signal.
+*/
+struct SignalDiagram
+{
+  static const int kMaxThresholds = 4;
+  static const unsigned int kMaxPoints = 2 * kMaxThresholds;
+
+  inline bool addPoint(const DiagramPoint& point)
   {
-    static ProcessedData fSingleton;
-    return fSingleton;
+    if (numberOfPoints == kMaxPoints)
+      return false;
+    points[numberOfPoints++] = point;
+    return true;
+  }
+  inline bool empty() const
+  {
+    return numberOfPoints == 0;
   }
+  inline unsigned int size() const
+  {
+    return numberOfPoints;
+  }
+  inline const DiagramPoint* begin() const
+  {
+    return points;
+  }
+  inline const DiagramPoint* end() const
+  {
+    return points + numberOfPoints;
+  }
+
+  JPetPM::Side side = JPetPM::SideA;
+  size_t layer = 0;
+  size_t slot = 0;
+  unsigned int numberOfPoints = 0;
+  DiagramPoint points[kMaxPoints];
+};
 
+typedef std::vector<SignalDiagram> SignalDiagrams;
+typedef std::vector<TVector3> HitPositions;
+typedef std::vector<double> HitTimes; // of hits in HitPositions, in ps
+
+/* Everything needed to draw a single event. Frames are filled by
+   DataProcessor, also on background threads, and moved to ProcessedData
+   when the event is shown.
+*/
+class DisplayFrame
+{
+public:
   void clearData()
   {
     fActivedScins.clear();
     fDiagram.clear();
     fHits.clear();
+    fHitTimes.clear();
     fInfo.clear();
   }
 
-  void addActivedScins(ScintillatorsInLayers scins)
-  {
-    fActivedScins.insert(scins.begin(), scins.end());
-  }
-  void addDiagram(DiagramDataMapVector diagram)
-  {
-    fDiagram.insert(fDiagram.end(), diagram.begin(), diagram.end());
-  }
   void setCurrentFileType(FileTypes type)
   {
     fCurrentFileType = type;
   }
-  void addHits(HitPositions hits)
-  {
-    fHits.insert(fHits.end(), hits.begin(), hits.end());
-  }
-
   inline FileTypes getCurrentFileType() const
   {
     return fCurrentFileType;
@@ -108,7 +151,7 @@ public:
   {
     return fActivedScins;
   }
-  inline DiagramDataMapVector& getDiagramData()
+  inline SignalDiagrams& getDiagramData()
   {
     return fDiagram;
   }
@@ -116,6 +159,11 @@ public:
   {
     return fHits;
   }
+  // not drawn, kept so that the display cache holds complete hits
+  inline HitTimes& getHitTimes()
+  {
+    return fHitTimes;
+  }
 
   inline void addToInfo(const std::string& str)
   {
@@ -127,35 +175,138 @@ public:
     return fInfo;
   }
 
-private:
-  ProcessedData() {}
+  // approximate number of bytes taken by the frame, used by FrameCache
+  size_t getMemorySize() const
+  {
+    return sizeof(DisplayFrame) + fInfo.capacity() +
+           fHits.capacity() * sizeof(TVector3) +
+           fHitTimes.capacity() * sizeof(double) +
+           fDiagram.capacity() * sizeof(SignalDiagram) +
+           fActivedScins.getMemorySize();
+  }
 
+private:
   std::string fInfo;
   ScintillatorsInLayers fActivedScins;
-  DiagramDataMapVector fDiagram;
+  SignalDiagrams fDiagram;
   HitPositions fHits;
+  HitTimes fHitTimes;
   FileTypes fCurrentFileType = FileTypes::fNone;
 };
 
+// Frame which is currently displayed
+class ProcessedData : public DisplayFrame
+{
+public:
+  ProcessedData(const ProcessedData&) = delete;
+  ProcessedData& operator=(const ProcessedData&) = delete;
+  ~ProcessedData() {}
+
+  static inline ProcessedData& getInstance()
+  {
+    static ProcessedData fSingleton;
+    return fSingleton;
+  }
+
+  void setFrame(DisplayFrame&& frame)
+  {
+    DisplayFrame::operator=(std::move(frame));
+  }
+
+private:
+  ProcessedData() {}
+};
+
+class DisplayCacheReader;
+class EventPrefetcher;
+class FileChain;
+class FrameCache;
+class OccupancyScanner;
+
 class DataProcessor
 {
 public:
-  DataProcessor(std::shared_ptr<JPetGeomMapping> fMapper);
+  DataProcessor(std::shared_ptr<JPetGeomMapping> fMapper,
+                const JPetParamBank& bank);
+  DataProcessor(std::shared_ptr<JPetGeomMapping> fMapper,
+                std::shared_ptr<const StripPosTable> stripPositions);
+  ~DataProcessor();
   void getDataForCurrentEvent();
   bool openFile(const char* filename);
+  bool openFile(const char* filename, const EventIndex& index);
+  bool openFiles(const std::vector<std::string>& filenames);
   void closeFile();
   bool firstEvent();
   bool nextEvent();
   bool lastEvent();
   bool nthEvent(long long n);
+  bool decodeEvent(long long n, DisplayFrame& frame);
   long long getNumberOfEvents()
   {
     return fNumberOfEventsInFile;
   }
+  bool isNumberOfEventsKnown()
+  {
+    return fChain ? fChainCounted : fEventIndexReady;
+  }
+  bool updateEventIndex();
+  bool waitForEventIndex();
+
+  bool follow(const char* path);
+  bool updateFollowed();
+  void stopFollowing();
+  bool isFollowing() const
+  {
+    return fFollowing;
+  }
 
   void changeResetLeadingEdge()
   {
-    fResetLeadingEdge = !fResetLeadingEdge;
+    setResetLeadingEdge(!fResetLeadingEdge);
+  }
+  void setResetLeadingEdge(bool reset);
+  bool getResetLeadingEdge() const
+  {
+    return fResetLeadingEdge;
+  }
+
+  void setFrameCacheSize(size_t megabytes);
+
+  void setRequiredData(unsigned int data);
+  unsigned int getRequiredData() const
+  {
+    return fRequiredData;
+  }
+  FileTypes getOpenedFileType() const
+  {
+    return fFileType;
+  }
+
+  // prefetching is useless when every event is decoded only once in order
+  void setPrefetchingEnabled(bool enabled);
+
+  void setPrefetchStep(long long step)
+  {
+    fPrefetchStep = step > 0 ? step : 1;
+  }
+
+  static FileTypes getFileType(const std::string& className);
+  static std::vector<std::string> getSkippedMembers(FileTypes fileType,
+      unsigned int requiredData);
+  /* Points of both edges, sorted by threshold number as returned by
+     JPetRawSignal::getPoints, are written into the diagram in one pass.
+     Returns number of points which were dropped, because their threshold
+     number is out of 1..SignalDiagram::kMaxThresholds.
+  */
+  static unsigned int fillDiagram(const std::vector<JPetSigCh>& leadingPoints,
+                                  const std::vector<JPetSigCh>& trailingPoints,
+                                  bool resetLeadingEdge, SignalDiagram& diagram);
+
+  bool startOccupancyScan(unsigned int numberOfThreads);
+  void stopOccupancyScan();
+  OccupancyScanner* getOccupancyScanner()
+  {
+    return fOccupancyScanner.get();
   }
 
 private:
@@ -163,31 +314,93 @@ private:
   DataProcessor(const DataProcessor&) = delete;
   DataProcessor& operator=(const DataProcessor&) = delete;
 
-  void addToSelectionIfNotPresent(ScintillatorsInLayers& selection,
-                                  StripPos& pos);
+  void addToSelection(ScintillatorsInLayers& selection, const StripPos& pos);
+
+  bool openReader(const char* filename);
+  std::shared_ptr<JPetParamBank> getParamBank(const std::string& filename);
+  bool openDisplayCache(const std::string& filename);
+  bool openFileInChain(size_t file);
+  void detectFileType();
+  void selectBranches();
+  void getDataForCurrentEvent(DisplayFrame& frame);
+
+  template <class T>
+  void extractEvent(const JPetTimeWindow& timeWindow, DisplayFrame& frame);
+  typedef void (DataProcessor::*ExtractEventFunction)(
+    const JPetTimeWindow& timeWindow, DisplayFrame& frame);
+
+  void getActiveScintillators(const JPetSigCh& sigCh, DisplayFrame& frame);
+  void getActiveScintillators(const JPetRawSignal& rawSignal,
+                              DisplayFrame& frame);
+  void getActiveScintillators(const JPetHit& hitSignal, DisplayFrame& frame);
+  void getActiveScintillators(const JPetEvent& event, DisplayFrame& frame);
+  std::string currentActivedScintillatorsInfo(DisplayFrame& frame);
 
-  void getActiveScintillators(const JPetSigCh& sigCh);
-  void getActiveScintillators(const JPetRawSignal& rawSignal);
-  void getActiveScintillators(const JPetHit& hitSignal);
-  void getActiveScintillators(const JPetEvent& event);
-  std::string currentActivedScintillatorsInfo();
+  bool getDataForDiagram(const JPetRawSignal& rawSignal,
+                         SignalDiagram& diagram);
+  void addDiagram(const JPetRawSignal& rawSignal, SignalDiagrams& diagrams);
+  void getDataForDiagram(const JPetRawSignal& rawSignal, DisplayFrame& frame);
+  void getDataForDiagram(const JPetHit& hitSignal, DisplayFrame& frame);
+  void getDataForDiagram(const JPetEvent& event, DisplayFrame& frame);
 
-  DiagramDataMap getDataForDiagram(const JPetRawSignal& rawSignal, bool);
-  // void getDataForDiagram(const JPetTimeWindow &tWindow);
-  void getDataForDiagram(const JPetRawSignal& rawSignal);
-  void getDataForDiagram(const JPetHit& hitSignal);
-  void getDataForDiagram(const JPetEvent& event);
+  void getHitsPosition(const JPetHit& hitSignal, DisplayFrame& frame);
+  void getHitsPosition(const JPetEvent& event, DisplayFrame& frame);
 
-  void getHitsPosition(const JPetHit& hitSignal);
-  void getHitsPosition(const JPetEvent& event);
+  void getHitsInfo(const JPetHit& hitSignal, DisplayFrame& frame);
+  void getHitsInfo(const JPetEvent& event, DisplayFrame& frame);
 
-  void addToInfoFromStripPos(const StripPos& pos, const JPetHit& hit);
+  void addToInfoFromStripPos(const StripPos& pos, const JPetHit& hit,
+                             DisplayFrame& frame);
+
+  void startPrefetching();
+  void stopPrefetching();
+
+  bool openFollowedFile(const std::string& filename);
+  void appendNewEntries(long long numberOfEntries);
+  bool followedDirectoryChanged();
+  static std::string findNewestFile(const std::string& directory);
+
+  void startEventIndexBuilding(const std::string& filename);
+  void stopEventIndexBuilding();
+  bool findEventByScanning(long long n, long long& entry,
+                           unsigned int& eventInEntry);
 
   long long fNumberOfEventsInFile = 0;
   unsigned int fNumberOfEventInCurrentTimeWindow = 0;
-  JPetReader fReader;
+  EventReader fReader;
+  std::shared_ptr<JPetParamBank> fParamBank; // of the opened file
+  FileTypes fFileType = FileTypes::fNone;
+  ExtractEventFunction fExtractEvent = nullptr;
+  EventIndex fEventIndex;
+  bool fEventIndexReady = false;
+  EventIndex fScannedIndex; // entries already scanned by findEventByScanning
+
+  std::thread fEventIndexThread;
+  std::mutex fEventIndexMutex;
+  std::atomic<bool> fStopEventIndexBuilding {false};
+  std::atomic<bool> fBuiltEventIndexAvailable {false};
+  EventIndex fBuiltEventIndex; // filled by fEventIndexThread
   std::shared_ptr<JPetGeomMapping> fMapper;
+  std::shared_ptr<const StripPosTable> fStripPositions;
   bool fResetLeadingEdge = false;
+  unsigned int fRequiredData = kAllData; // FrameData flags
+
+  std::string fFileName;
+  bool fFollowing = false;
+  std::unique_ptr<DisplayCacheReader> fDisplayCache;
+  std::unique_ptr<FileChain> fChain;
+  bool fChainCounted = false;
+  long long fCurrentFileInChain = -1;
+  std::string fFollowedDirectory;
+  std::string fNewestFollowedFile; // from the last listing of the directory
+  Long_t fFollowedDirectoryTime = 0;        // modification time
+  Long_t fFollowedDirectoryListingTime = 0; // when it was listed
+  std::unique_ptr<EventPrefetcher> fPrefetcher;
+  std::unique_ptr<FrameCache> fFrameCache;
+  std::unique_ptr<OccupancyScanner> fOccupancyScanner;
+  long long fPrefetchStep = 1;
+  bool fPrefetchingEnabled = true;
+  static const unsigned int kNumberOfPrefetchedEvents = 16;
 #endif
 };
 } // namespace jpet_event_display
@@ -0,0 +1,399 @@
+/**
+ *  @copyright Copyright 2016 The J-PET Framework Authors. All rights reserved.
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may find a copy of the License in the LICENCE file.
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *  @file DisplayCache.cpp
+ */
+
+#include "./DisplayCache.h"
+#include <JPetLoggerInclude.h>
+#include <TSystem.h>
+#include <cstdio>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <type_traits>
+#include <unistd.h>
+
+namespace jpet_event_display
+{
+namespace display_cache
+{
+const char kMagic[8] = {'J', 'P', 'E', 'T', 'E', 'V', 'D', 'C'};
+
+// size of a single record in each column
+const uint64_t kRecordSize[4] = {sizeof(StripRecord), sizeof(SignalDiagram),
+                                 sizeof(HitRecord), sizeof(char)
+                                };
+
+static_assert(std::is_trivially_copyable<SignalDiagram>::value,
+              "SignalDiagram is stored in display cache as raw bytes");
+
+std::string getCacheFileName(const std::string& dataFileName)
+{
+  return dataFileName + ".evdc";
+}
+
+bool getDataFileStamp(const std::string& dataFileName, int64_t& size,
+                      int64_t& modTime)
+{
+  Long_t id = 0, flags = 0, modificationTime = 0;
+  Long64_t fileSize = 0;
+  if (gSystem->GetPathInfo(dataFileName.c_str(), &id, &fileSize, &flags,
+                           &modificationTime) != 0)
+    return false;
+  size = fileSize;
+  modTime = modificationTime;
+  return true;
+}
+
+static inline uint64_t align(uint64_t position)
+{
+  return (position + 7) & ~static_cast<uint64_t>(7);
+}
+
+static void pad(std::ofstream& out, uint64_t position)
+{
+  static const char zeros[8] = {};
+  uint64_t current = static_cast<uint64_t>(out.tellp());
+  if (current < position)
+    out.write(zeros, position - current);
+}
+} // namespace display_cache
+
+using namespace display_cache;
+
+DisplayCacheWriter::~DisplayCacheWriter()
+{
+  if (fOpen) { // not closed, result is not complete
+    for (std::ofstream& column : fColumns)
+      column.close();
+    removeColumnFiles();
+  }
+}
+
+std::string DisplayCacheWriter::getColumnFileName(int column) const
+{
+  return fFileName + ".column" + std::to_string(column);
+}
+
+void DisplayCacheWriter::removeColumnFiles()
+{
+  for (int i = 0; i < 4; i++)
+    std::remove(getColumnFileName(i).c_str());
+}
+
+bool DisplayCacheWriter::open(const std::string& fileName,
+                              const std::string& dataFileName)
+{
+  fFileName = fileName;
+  std::memset(&fHeader, 0, sizeof(fHeader));
+  std::memcpy(fHeader.magic, kMagic, sizeof(kMagic));
+  fHeader.version = kVersion;
+  int64_t size = 0, modTime = 0;
+  if (getDataFileStamp(dataFileName, size, modTime)) {
+    fHeader.dataFileSize = size;
+    fHeader.dataFileModTime = modTime;
+  }
+  for (int i = 0; i < 4; i++) {
+    fColumns[i].open(getColumnFileName(i).c_str(),
+                     std::ios_base::out | std::ios_base::binary);
+    if (!fColumns[i]) {
+      ERROR("Could not create display cache file: " + getColumnFileName(i));
+      for (int j = 0; j <= i; j++)
+        fColumns[j].close();
+      removeColumnFiles();
+      return false;
+    }
+    fOffsets[i].assign(1, 0);
+  }
+  fOpen = true;
+  return true;
+}
+
+void DisplayCacheWriter::addFrame(DisplayFrame& frame)
+{
+  if (fHeader.numberOfEvents == 0)
+    fHeader.fileType = frame.getCurrentFileType();
+
+  const ScintillatorsInLayers& strips = frame.getActivedScintilators();
+  for (const auto& strip : strips) {
+    StripRecord record {static_cast<uint32_t>(strip.layer),
+                        static_cast<uint32_t>(strip.slot), strip.hits};
+    fColumns[0].write(reinterpret_cast<const char*>(&record),
+                                      sizeof(record));
+  }
+  fOffsets[kStripOffsets].push_back(fOffsets[kStripOffsets].back() +
+                                    strips.size());
+
+  const SignalDiagrams& diagrams = frame.getDiagramData();
+  fColumns[1].write(
+    reinterpret_cast<const char*>(diagrams.data()),
+    diagrams.size() * sizeof(SignalDiagram));
+  fOffsets[kDiagramOffsets].push_back(fOffsets[kDiagramOffsets].back() +
+                                      diagrams.size());
+
+  const HitPositions& hits = frame.getHits();
+  const HitTimes& times = frame.getHitTimes();
+  for (size_t i = 0; i < hits.size(); i++) {
+    const TVector3& hit = hits[i];
+    HitRecord record {hit.X(), hit.Y(), hit.Z(),
+                      i < times.size() ? times[i] : 0.};
+    fColumns[2].write(reinterpret_cast<const char*>(&record),
+                                    sizeof(record));
+  }
+  fOffsets[kHitOffsets].push_back(fOffsets[kHitOffsets].back() + hits.size());
+
+  const std::string& info = frame.getInfo();
+  fColumns[3].write(info.data(), info.size());
+  fOffsets[kInfoOffsets].push_back(fOffsets[kInfoOffsets].back() +
+                                   info.size());
+
+  fHeader.numberOfEvents++;
+}
+
+bool DisplayCacheWriter::close()
+{
+  if (!fOpen)
+    return false;
+  fOpen = false;
+  bool result = true;
+  for (std::ofstream& column : fColumns) {
+    column.close();
+    result = result && !column.fail();
+  }
+  uint64_t position = align(sizeof(Header));
+  for (int i = 0; i < kNumberOfSections; i++) {
+    fHeader.sectionPosition[i] = position;
+    fHeader.sectionSize[i] =
+      i < kStrips ? fOffsets[i].size() * sizeof(uint64_t)
+      : fOffsets[i - kStrips].back() * kRecordSize[i - kStrips];
+    position = align(position + fHeader.sectionSize[i]);
+  }
+
+  // readers never see a partially written cache, it appears by rename
+  std::string temporaryFileName = fFileName + ".tmp";
+  std::ofstream out(temporaryFileName.c_str(),
+                    std::ios_base::out | std::ios_base::binary);
+  out.write(reinterpret_cast<const char*>(&fHeader), sizeof(fHeader));
+  for (int i = 0; i < kStrips; i++) {
+    pad(out, fHeader.sectionPosition[i]);
+    out.write(reinterpret_cast<const char*>(fOffsets[i].data()),
+              fHeader.sectionSize[i]);
+  }
+  for (int i = kStrips; i < kNumberOfSections; i++) {
+    pad(out, fHeader.sectionPosition[i]);
+    std::ifstream column(getColumnFileName(i - kStrips).c_str(),
+                         std::ios_base::in | std::ios_base::binary);
+    if (fHeader.sectionSize[i] > 0)
+      out << column.rdbuf();
+  }
+  result = result && static_cast<bool>(out);
+  out.close();
+  result = result && !out.fail();
+  removeColumnFiles();
+  if (result)
+    result = std::rename(temporaryFileName.c_str(), fFileName.c_str()) == 0;
+  if (!result) {
+    ERROR("Could not write display cache file: " + fFileName);
+    std::remove(temporaryFileName.c_str());
+  }
+  return result;
+}
+
+/* Processor should have the data file opened, with prefetching disabled
+   (see DataProcessor::setPrefetchingEnabled). Diagrams are extracted without
+   resetting leading edge, the processor setting is restored on return.
+*/
+bool DisplayCacheWriter::convert(DataProcessor& processor,
+                                 const std::string& fileName,
+                                 const std::string& dataFileName)
+{
+  struct ResetLeadingEdgeGuard {
+    DataProcessor& processor;
+    bool previous;
+    ~ResetLeadingEdgeGuard()
+    {
+      processor.setResetLeadingEdge(previous);
+    }
+  } guard {processor, processor.getResetLeadingEdge()};
+  processor.setResetLeadingEdge(false);
+  if (!processor.waitForEventIndex()) {
+    ERROR("Could not count events in file: " + dataFileName);
+    return false;
+  }
+  DisplayCacheWriter writer;
+  if (!writer.open(fileName, dataFileName))
+    return false;
+  DisplayFrame frame; // reused, so decoding does not allocate per event
+  long long numberOfEvents = processor.getNumberOfEvents();
+  for (long long i = 0; i < numberOfEvents; i++) {
+    if (!processor.decodeEvent(i, frame)) {
+      ERROR("Could not read event " + std::to_string(i));
+      return false;
+    }
+    writer.addFrame(frame);
+  }
+  return writer.close();
+}
+
+DisplayCacheReader::~DisplayCacheReader()
+{
+  close();
+}
+
+bool DisplayCacheReader::open(const std::string& fileName)
+{
+  close();
+  int fd = ::open(fileName.c_str(), O_RDONLY);
+  if (fd < 0)
+    return false;
+  struct stat fileStat;
+  if (fstat(fd, &fileStat) != 0 ||
+      static_cast<size_t>(fileStat.st_size) < sizeof(Header)) {
+    ::close(fd);
+    return false;
+  }
+  void* data = mmap(nullptr, fileStat.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+  ::close(fd); // mapping stays valid
+  if (data == MAP_FAILED) {
+    ERROR("Could not map display cache file: " + fileName);
+    return false;
+  }
+  fData = static_cast<const char*>(data);
+  fSize = fileStat.st_size;
+  fHeader = reinterpret_cast<const Header*>(fData);
+  if (!validate()) {
+    WARNING("Display cache file is corrupted or outdated: " + fileName);
+    close();
+    return false;
+  }
+  return true;
+}
+
+void DisplayCacheReader::close()
+{
+  if (fData)
+    munmap(const_cast<char*>(fData), fSize);
+  fData = nullptr;
+  fSize = 0;
+  fHeader = nullptr;
+}
+
+bool DisplayCacheReader::validate() const
+{
+  if (std::memcmp(fHeader->magic, kMagic, sizeof(kMagic)) != 0 ||
+      fHeader->version != kVersion || fHeader->fileType > FileTypes::fSigCh)
+    return false;
+  for (int i = 0; i < kNumberOfSections; i++) {
+    uint64_t position = fHeader->sectionPosition[i];
+    uint64_t size = fHeader->sectionSize[i];
+    if (position % 8 != 0 || position > fSize || size > fSize - position)
+      return false;
+  }
+  for (int i = 0; i < kStrips; i++) {
+    if (fHeader->sectionSize[i] !=
+        (fHeader->numberOfEvents + 1) * sizeof(uint64_t))
+      return false;
+    const uint64_t* offsets = section<uint64_t>(static_cast<Section>(i));
+    if (offsets[0] != 0 || offsets[fHeader->numberOfEvents] *
+        kRecordSize[i] != fHeader->sectionSize[i + kStrips])
+      return false;
+  }
+  return true;
+}
+
+bool DisplayCacheReader::matchesDataFile(const std::string& dataFileName) const
+{
+  int64_t size = 0, modTime = 0;
+  return fHeader && getDataFileStamp(dataFileName, size, modTime) &&
+         fHeader->dataFileSize == size && fHeader->dataFileModTime == modTime;
+}
+
+/* Leading edge times are set to 0 and trailing ones are shifted by the
+   leading time of the same threshold, as in DataProcessor::getDataForDiagram.
+*/
+void DisplayCacheReader::resetLeadingEdge(SignalDiagram& diagram)
+{
+  bool hasLeading[SignalDiagram::kMaxThresholds + 1] = {};
+  float leadingTime[SignalDiagram::kMaxThresholds + 1] = {};
+  float startPos = 0.f;
+  bool hasStart = false;
+  for (const DiagramPoint& point : diagram) {
+    if (point.edge != JPetSigCh::Leading || point.thresholdNumber < 1 ||
+        point.thresholdNumber > SignalDiagram::kMaxThresholds)
+      continue;
+    if (!hasStart) {
+      startPos = point.time;
+      hasStart = true;
+    }
+    hasLeading[point.thresholdNumber] = true;
+    leadingTime[point.thresholdNumber] = point.time;
+  }
+  for (unsigned int i = 0; i < diagram.numberOfPoints; i++) {
+    DiagramPoint& point = diagram.points[i];
+    if (point.edge == JPetSigCh::Leading)
+      point.time = 0.f;
+    else if (point.thresholdNumber >= 1 &&
+             point.thresholdNumber <= SignalDiagram::kMaxThresholds &&
+             hasLeading[point.thresholdNumber])
+      point.time -= leadingTime[point.thresholdNumber];
+    else
+      point.time -= startPos;
+  }
+}
+
+bool DisplayCacheReader::readFrame(long long eventNumber, DisplayFrame& frame,
+                                   bool resetLeading) const
+{
+  if (!fHeader || eventNumber < 0 || eventNumber >= getNumberOfEvents())
+    return false;
+  uint64_t begin[4], end[4];
+  for (int i = 0; i < kStrips; i++) {
+    const uint64_t* offsets = section<uint64_t>(static_cast<Section>(i));
+    begin[i] = offsets[eventNumber];
+    end[i] = offsets[eventNumber + 1];
+    if (begin[i] > end[i] ||
+        end[i] > fHeader->sectionSize[i + kStrips] / kRecordSize[i])
+      return false;
+  }
+  frame.clearData();
+  frame.setCurrentFileType(getFileType());
+
+  const StripRecord* strips = section<StripRecord>(kStrips);
+  for (uint64_t i = begin[0]; i < end[0]; i++)
+    frame.getActivedScintilators().add(strips[i].layer, strips[i].slot,
+                                       strips[i].hits);
+
+  const SignalDiagram* diagrams = section<SignalDiagram>(kDiagrams);
+  SignalDiagrams& frameDiagrams = frame.getDiagramData();
+  frameDiagrams.assign(diagrams + begin[1], diagrams + end[1]);
+  if (resetLeading) {
+    for (SignalDiagram& diagram : frameDiagrams)
+      resetLeadingEdge(diagram);
+  }
+
+  const HitRecord* hits = section<HitRecord>(kHits);
+  HitPositions& frameHits = frame.getHits();
+  HitTimes& frameHitTimes = frame.getHitTimes();
+  frameHits.reserve(end[2] - begin[2]);
+  frameHitTimes.reserve(end[2] - begin[2]);
+  for (uint64_t i = begin[2]; i < end[2]; i++) {
+    frameHits.emplace_back(hits[i].x, hits[i].y, hits[i].z);
+    frameHitTimes.push_back(hits[i].time);
+  }
+
+  const char* info = section<char>(kInfo);
+  frame.addToInfo(std::string(info + begin[3], end[3] - begin[3]));
+  return true;
+}
+} // namespace jpet_event_display
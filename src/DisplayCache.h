@@ -0,0 +1,151 @@
+/**
+ *  @copyright Copyright 2016 The J-PET Framework Authors. All rights reserved.
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may find a copy of the License in the LICENCE file.
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *  @brief Compact file with display frames of all events, read with mmap.
+ */
+
+#ifndef DISPLAYCACHE_H
+#define DISPLAYCACHE_H
+
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include "DataProcessor.h"
+
+namespace jpet_event_display
+{
+/* Display cache file keeps exactly what is needed to draw each event (see
+   DisplayFrame), so a converted run is shown without ROOT deserialisation.
+   Layout (native endianness, every section aligned to 8 bytes):
+   header, 4 offset tables (strips, diagrams, hits, info), each with
+   number of events + 1 elements, and 4 columns with records of all events
+   one after another. Records of event i in a column are
+   [offsets[i], offsets[i + 1]). Diagram times are stored without resetting
+   leading edge, reset is applied when frame is read.
+*/
+namespace display_cache
+{
+enum Section {
+  kStripOffsets,
+  kDiagramOffsets,
+  kHitOffsets,
+  kInfoOffsets,
+  kStrips,
+  kDiagrams,
+  kHits,
+  kInfo,
+  kNumberOfSections
+};
+
+struct Header {
+  char magic[8];
+  uint32_t version;
+  uint32_t fileType;
+  int64_t dataFileSize;
+  int64_t dataFileModTime;
+  uint64_t numberOfEvents;
+  uint64_t sectionPosition[kNumberOfSections]; // in bytes from file start
+  uint64_t sectionSize[kNumberOfSections];     // in bytes
+};
+
+struct StripRecord {
+  uint32_t layer;
+  uint32_t slot;
+  uint32_t hits;
+};
+
+struct HitRecord {
+  double x;
+  double y;
+  double z;
+  double time; // in ps
+};
+
+extern const char kMagic[8];
+const uint32_t kVersion = 2; // 2: time of hits
+
+std::string getCacheFileName(const std::string& dataFileName);
+bool getDataFileStamp(const std::string& dataFileName, int64_t& size,
+                      int64_t& modTime);
+} // namespace display_cache
+
+/* Columns are written to temporary files while frames are added and joined
+   with the offset tables in close().
+*/
+class DisplayCacheWriter
+{
+public:
+  ~DisplayCacheWriter();
+
+  bool open(const std::string& fileName, const std::string& dataFileName);
+  void addFrame(DisplayFrame& frame);
+  bool close();
+
+  static bool convert(DataProcessor& processor, const std::string& fileName,
+                      const std::string& dataFileName);
+
+private:
+  std::string getColumnFileName(int column) const;
+  void removeColumnFiles();
+
+  std::string fFileName;
+  display_cache::Header fHeader;
+  // strips, diagrams, hits and info, in order of sections
+  std::ofstream fColumns[4];
+  std::vector<uint64_t> fOffsets[4];
+  bool fOpen = false;
+};
+
+class DisplayCacheReader
+{
+public:
+  DisplayCacheReader() {}
+  ~DisplayCacheReader();
+
+  bool open(const std::string& fileName);
+  void close();
+  bool matchesDataFile(const std::string& dataFileName) const;
+  bool readFrame(long long eventNumber, DisplayFrame& frame,
+                 bool resetLeadingEdge) const;
+
+  inline long long getNumberOfEvents() const
+  {
+    return fHeader ? static_cast<long long>(fHeader->numberOfEvents) : 0;
+  }
+  inline FileTypes getFileType() const
+  {
+    return fHeader ? static_cast<FileTypes>(fHeader->fileType)
+           : FileTypes::fNone;
+  }
+
+  static void resetLeadingEdge(SignalDiagram& diagram);
+
+private:
+  DisplayCacheReader(const DisplayCacheReader&) = delete;
+  DisplayCacheReader& operator=(const DisplayCacheReader&) = delete;
+
+  template <class T>
+  const T* section(display_cache::Section section) const
+  {
+    return reinterpret_cast<const T*>(fData + fHeader->sectionPosition[section]);
+  }
+  bool validate() const;
+
+  const char* fData = nullptr;
+  size_t fSize = 0;
+  const display_cache::Header* fHeader = nullptr;
+};
+} // namespace jpet_event_display
+
+#endif /*  !DISPLAYCACHE_H */
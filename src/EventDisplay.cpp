@@ -14,13 +14,20 @@
  */
 
 #include "EventDisplay.h"
+#include "FileChain.h"
+#include "OccupancyScanner.h"
+#include "StageTimer.h"
 #include <JPetLoggerInclude.h>
+#include <algorithm>
+#include <iomanip>
+#include <sstream>
 
 namespace jpet_event_display
 {
 
 const char* filetypes[] = {
-  "All files", "*", "ROOT files", "*.root", "Text files", "*.[tT][xX][tT]",
+  "All files", "*", "ROOT files", "*.root",
+  "Display cache", "*.evdc", "Text files", "*.[tT][xX][tT]",
   0, 0
 };
 
@@ -32,23 +39,58 @@ EventDisplay::~EventDisplay()
 }
 
 void EventDisplay::run(
-  std::shared_ptr<JPetGeomMapping> mapper, const int numberOfLayers,
+  std::shared_ptr<JPetGeomMapping> mapper, const JPetParamBank& bank,
+  const int numberOfLayers,
   const int scintillatorLenght,
-  const std::vector<std::pair<int, double>>& layerStats)
+  const std::vector<std::pair<int, double>>& layerStats,
+  const size_t frameCacheSizeInMB)
 {
 
-  dataProcessor = std::unique_ptr<DataProcessor>(new DataProcessor(mapper));
+  dataProcessor = std::unique_ptr<DataProcessor>(new DataProcessor(mapper, bank));
+  dataProcessor->setFrameCacheSize(frameCacheSizeInMB);
+  dataProcessor->setRequiredData(
+    getRequiredData(GeometryVisualizator::k3dView, false));
   visualizator = std::unique_ptr<GeometryVisualizator>(
                    new GeometryVisualizator(numberOfLayers, scintillatorLenght, layerStats));
+  visualizator->setAccumulationLimits(fAccumulationCapacity,
+                                      fAccumulationCellSize);
   fGUIControls->eventNo = 0;
   fGUIControls->stepNo = 0;
   createGUI();
   updateGUIControlls();
   visualizator->showGeometry();
+  if (!fFollowPath.empty()) {
+    fFollowCheck->SetState(kButtonDown);
+    startFollowing(fFollowPath.c_str());
+  }
   fApplication->Run();
   INFO("J-PET Event Display created");
   INFO("*********************");
 }
+/* Timing of stages is collected from start, trace of all measured intervals
+   is written when the window is closed if a file name is given.
+*/
+void EventDisplay::setProfiling(bool enabled, const std::string& traceFileName)
+{
+  fTraceFileName = traceFileName;
+  Profiler::getInstance().setEnabled(enabled || !traceFileName.empty());
+  Profiler::getInstance().setTracing(!traceFileName.empty());
+}
+
+void EventDisplay::setAccumulation(size_t capacity, double cellSize)
+{
+  fAccumulationCapacity = capacity;
+  fAccumulationCellSize = cellSize;
+}
+
+// path to file or directory followed since start, see DataProcessor::follow
+void EventDisplay::setFollow(const std::string& path, double refreshRate)
+{
+  fFollowPath = path;
+  if (refreshRate > 0)
+    fFollowRefreshRate = refreshRate;
+}
+
 void EventDisplay::createGUI()
 {
   fMainWindow =
@@ -94,6 +136,15 @@ void EventDisplay::createGUI()
   CreateOptionsFrame(optionsFrame);
   CreateDisplayFrame(displayFrame);
 
+  // rolling averages of pipeline stages, see updateStatusBar
+  fStatusBar = new TGStatusBar(baseFrame, w_GlobalFrame, 20);
+  Int_t statusBarParts[] = {20, 20, 20, 20, 20};
+  fStatusBar->SetParts(statusBarParts, 5);
+  baseFrame->AddFrame(fStatusBar,
+                      new TGLayoutHints(kLHintsBottom | kLHintsExpandX, 0, 0,
+                                        2, 0));
+  updateStatusBar();
+
   globalFrame->Resize(globalFrame->GetDefaultSize());
   baseFrame->Resize(baseFrame->GetDefaultSize());
 
@@ -118,6 +169,8 @@ void EventDisplay::CreateDisplayFrame(TGGroupFrame* parentFrame)
          "diagramCanvas");
 
   fDisplayTabView->SetEnabled(1, kTRUE);
+  fDisplayTabView->Connect("Selected(Int_t)", "jpet_event_display::EventDisplay",
+                           this, "changeView(Int_t)");
   parentFrame->AddFrame(
     fDisplayTabView.get(),
     new TGLayoutHints(kLHintsTop | kLHintsExpandX | kLHintsExpandY, 2, 2, 5,
@@ -135,9 +188,10 @@ void EventDisplay::CreateOptionsFrame(TGGroupFrame* parentFrame)
                       kLHintsExpandX | kLHintsExpandY, 2, 2, 2, 2);
 
   AddButton(frame1_1_2, "Read Data", "handleMenu(=1)");
+  AddButton(frame1_1_2, "Occupancy", "startOccupancyScan()");
 
   TGCheckButton* markersCheck =
-    new TGCheckButton(frame1_1, "Save markers and lines between events", 1);
+    new TGCheckButton(frame1_1, "Save markers between events", 1);
   frame1_1->AddFrame(
     markersCheck,
     new TGLayoutHints(kLHintsExpandX | kLHintsExpandY, 5, 5, 3, 4));
@@ -145,6 +199,15 @@ void EventDisplay::CreateOptionsFrame(TGGroupFrame* parentFrame)
   markersCheck->Connect("Clicked()", "jpet_event_display::EventDisplay", this,
                         "checkBoxMarkersSignalFunction()");
 
+  TGCheckButton* densityCheck = new TGCheckButton(
+    frame1_1, "Show density of hits on top and unrolled views", 1);
+  frame1_1->AddFrame(
+    densityCheck,
+    new TGLayoutHints(kLHintsExpandX | kLHintsExpandY, 5, 5, 3, 4));
+  densityCheck->ChangeBackground(fFrameBackgroundColor);
+  densityCheck->Connect("Clicked()", "jpet_event_display::EventDisplay", this,
+                        "checkBoxDensitySignalFunction()");
+
   TGCheckButton* leadingEdgeCheck =
     new TGCheckButton(frame1_1, "Reset leading edge to 0", 1);
   frame1_1->AddFrame(
@@ -154,6 +217,25 @@ void EventDisplay::CreateOptionsFrame(TGGroupFrame* parentFrame)
   leadingEdgeCheck->Connect("Clicked()", "jpet_event_display::EventDisplay", this,
                             "changeResetLeadingEdge()");
 
+  fFollowCheck =
+    new TGCheckButton(frame1_1, "Follow file (show newest events)", 1);
+  frame1_1->AddFrame(
+    fFollowCheck,
+    new TGLayoutHints(kLHintsExpandX | kLHintsExpandY, 5, 5, 3, 4));
+  fFollowCheck->ChangeBackground(fFrameBackgroundColor);
+  fFollowCheck->Connect("Clicked()", "jpet_event_display::EventDisplay", this,
+                        "followSignalFunction()");
+
+  fTimingCheck = new TGCheckButton(frame1_1, "Show timing of stages", 1);
+  frame1_1->AddFrame(
+    fTimingCheck,
+    new TGLayoutHints(kLHintsExpandX | kLHintsExpandY, 5, 5, 3, 4));
+  fTimingCheck->ChangeBackground(fFrameBackgroundColor);
+  if (Profiler::getInstance().isEnabled())
+    fTimingCheck->SetState(kButtonDown);
+  fTimingCheck->Connect("Clicked()", "jpet_event_display::EventDisplay", this,
+                        "timingSignalFunction()");
+
   TGCompositeFrame* frame1_2 =
     AddCompositeFrame(parentFrame, 1, 1, kVerticalFrame,
                       kLHintsExpandX | kLHintsExpandY, 1, 1, 1, 1);
@@ -191,7 +273,37 @@ void EventDisplay::CreateOptionsFrame(TGGroupFrame* parentFrame)
   AddButton(frame1_3_1, "&Next >", "doNext()");
   AddButton(frame1_3_1, "&Reset >", "doReset()");
   AddButton(frame1_3_1, "Show Data", "showData()");
-  AddButton(frame1_3_1, "Start Virt", "startVirtualization()");
+
+  TGCompositeFrame* frame1_3_3 =
+    AddCompositeFrame(frame1_3, 1, 1, kHorizontalFrame,
+                      kLHintsExpandX | kLHintsTop, 2, 2, 2, 2);
+
+  AddButton(frame1_3_3, "&Play", "startPlayback()");
+  AddButton(frame1_3_3, "P&ause", "pausePlayback()");
+  AddButton(frame1_3_3, "S&top", "stopPlayback()");
+
+  TGLabel* labelRate = new TGLabel(
+    frame1_3_3, "Events/s", TGLabel::GetDefaultGC()(),
+    TGLabel::GetDefaultFontStruct(), kChildFrame, fFrameBackgroundColor);
+  labelRate->SetTextJustify(36);
+  frame1_3_3->AddFrame(labelRate,
+                       new TGLayoutHints(kLHintsLeft | kLHintsCenterY, 2, 2, 2, 2));
+
+  fPlaybackRate = new TGNumberEntry(frame1_3_3, 25, 5, -1,
+                                    TGNumberFormat::kNESRealOne,
+                                    TGNumberFormat::kNEAPositive,
+                                    TGNumberFormat::kNELLimitMinMax, 0.1, 1000);
+  frame1_3_3->AddFrame(fPlaybackRate,
+                       new TGLayoutHints(kLHintsCenterY, 5, 5, 3, 4));
+  fPlaybackRate->Connect("ValueSet(Long_t)", "jpet_event_display::EventDisplay",
+                         this, "changePlaybackRate()");
+
+  fPlaybackInfo = new TGLabel(
+    frame1_3, "Playback stopped", TGLabel::GetDefaultGC()(),
+    TGLabel::GetDefaultFontStruct(), kChildFrame, fFrameBackgroundColor);
+  fPlaybackInfo->SetTextJustify(kTextLeft);
+  frame1_3->AddFrame(fPlaybackInfo,
+                     new TGLayoutHints(kLHintsExpandX, 5, 5, 2, 2));
 
   TGCompositeFrame* frame1_3_2 =
     AddCompositeFrame(frame1_3, 1, 1, kHorizontalFrame,
@@ -324,6 +436,9 @@ void EventDisplay::AddMenuBar(TGCompositeFrame* parentFrame)
 
 void EventDisplay::CloseWindow()
 {
+  if (!fTraceFileName.empty() &&
+      Profiler::getInstance().dumpTrace(fTraceFileName))
+    INFO("Timing trace written to " + fTraceFileName);
   gApplication->Terminate();
 }
 
@@ -334,15 +449,32 @@ void EventDisplay::handleMenu(Int_t id)
     TString dir("");
     fFileInfo->fFileTypes = filetypes;
     fFileInfo->fIniDir = StrDup(dir);
+    fFileInfo->SetMultipleSelection(kTRUE);
     new TGFileDialog(gClient->GetRoot(), fMainWindow.get(), kFDOpen,
                      fFileInfo.get());
     if (fFileInfo->fFilename == 0)
       return;
     assert(dataProcessor);
-    dataProcessor->openFile(fFileInfo->fFilename);
+    if (fOccupancyTimer)
+      fOccupancyTimer->Stop();
+    pausePlayback(); // events of the new file are not played
+    stopFollowing();
+    fFollowPath.clear();
+    dataProcessor->openFiles(getSelectedFiles());
     visualizator->clearAllCanvases();
     showData();
-    setMaxProgressBar(dataProcessor->getNumberOfEvents());
+    if (dataProcessor->isNumberOfEventsKnown()) {
+      setMaxProgressBar(dataProcessor->getNumberOfEvents());
+    } else {
+      fProgBar->Format("%.0f events (counting...)");
+      if (!fEventCountTimer) {
+        fEventCountTimer = std::unique_ptr<TTimer>(new TTimer(500));
+        fEventCountTimer->Connect("Timeout()",
+                                  "jpet_event_display::EventDisplay", this,
+                                  "checkEventCount()");
+      }
+      fEventCountTimer->Start(500);
+    }
   }
   break;
   case E_Close: {
@@ -353,10 +485,28 @@ void EventDisplay::handleMenu(Int_t id)
   return;
 }
 
+/* Several selected files, or a single list file or wildcard pattern, are
+   opened as one dataset, see FileChain::expandFileNames.
+*/
+std::vector<std::string> EventDisplay::getSelectedFiles()
+{
+  std::vector<std::string> fileNames;
+  TList* selected = fFileInfo->fFileNamesList;
+  if (selected && selected->GetSize() > 1) {
+    TIter next(selected);
+    while (TObject* fileName = next())
+      fileNames.push_back(fileName->GetName());
+    return fileNames;
+  }
+  return FileChain::expandFileNames(fFileInfo->fFilename);
+}
+
 void EventDisplay::updateGUIControlls()
 {
   fGUIControls->eventNo = fNumberEntryEventNo->GetIntNumber();
-  fGUIControls->stepNo = fNumberEntryStep->GetIntNumber();
+  // with step 0 playback and next would show the same event forever
+  fGUIControls->stepNo = std::max<Long_t>(fNumberEntryStep->GetIntNumber(), 1);
+  dataProcessor->setPrefetchStep(fGUIControls->stepNo);
 }
 
 void EventDisplay::doReset()
@@ -382,6 +532,7 @@ void EventDisplay::showData()
   drawSelectedStrips();
   updateProgressBar();
   fInputInfo->ChangeText(ProcessedData::getInstance().getInfo().c_str());
+  updateStatusBar();
 }
 
 void EventDisplay::drawSelectedStrips()
@@ -393,29 +544,302 @@ void EventDisplay::setMaxProgressBar(Int_t maxEvent)
 {
   fProgBar->Format(Form("%%.0f/%d events", maxEvent));
   fProgBar->SetRange(0.0f, Float_t(maxEvent));
+  if (maxEvent > 0)
+    fNumberEntryEventNo->SetLimitValues(0, maxEvent - 1);
+}
+
+void EventDisplay::checkEventCount()
+{
+  dataProcessor->updateEventIndex(); // index could also be taken by showData
+  if (!dataProcessor->isNumberOfEventsKnown())
+    return;
+  fEventCountTimer->Stop();
+  setMaxProgressBar(dataProcessor->getNumberOfEvents());
+  updateProgressBar();
+}
+
+void EventDisplay::startOccupancyScan()
+{
+  if (!dataProcessor->isNumberOfEventsKnown()) {
+    fInputInfo->ChangeText("Occupancy: wait until events are counted");
+    return;
+  }
+  unsigned int numberOfThreads = std::thread::hardware_concurrency();
+  if (!dataProcessor->startOccupancyScan(numberOfThreads))
+    return;
+  if (!fOccupancyTimer) {
+    fOccupancyTimer = std::unique_ptr<TTimer>(new TTimer(500));
+    fOccupancyTimer->Connect("Timeout()", "jpet_event_display::EventDisplay",
+                             this, "checkOccupancyScan()");
+  }
+  fOccupancyTimer->Start(500);
+}
+
+// partial occupancy is drawn while scan is running
+void EventDisplay::checkOccupancyScan()
+{
+  OccupancyScanner* scanner = dataProcessor->getOccupancyScanner();
+  if (!scanner) {
+    fOccupancyTimer->Stop();
+    return;
+  }
+  bool finished = scanner->isFinished();
+  long long processed = scanner->getNumberOfProcessedEvents();
+  long long all = scanner->getNumberOfEvents();
+  StripOccupancy occupancy = scanner->getOccupancy();
+  visualizator->drawOccupancy(occupancy);
+  // signal files have one active strip entry per channel, not per hit
+  FileTypes fileType = dataProcessor->getOpenedFileType();
+  const char* counted =
+    fileType == FileTypes::fSigCh || fileType == FileTypes::fRawSignal
+    ? " channels" : " hits";
+  std::ostringstream oss;
+  oss << "Occupancy" << (finished ? "" : " (scanning...)") << "\n"
+      << processed << "/" << all << " events\n"
+      << occupancy.getTotal() << counted << "\n"
+      << "max " << occupancy.getMaximum() << counted << " in strip\n";
+  fInputInfo->ChangeText(oss.str().c_str());
+  if (finished) {
+    fOccupancyTimer->Stop();
+    dataProcessor->stopOccupancyScan();
+  }
+}
+
+void EventDisplay::followSignalFunction()
+{
+  if (!fFollowCheck->IsOn()) {
+    stopFollowing();
+    return;
+  }
+  startFollowing(!fFollowPath.empty() ? fFollowPath.c_str()
+                 : fFileInfo->fFilename);
+}
+
+void EventDisplay::startFollowing(const char* path)
+{
+  pausePlayback(); // followed file shows its newest events instead
+  if (!path || !dataProcessor->follow(path)) {
+    fFollowCheck->SetState(kButtonUp);
+    return;
+  }
+  fFollowPath = path;
+  if (fEventCountTimer)
+    fEventCountTimer->Stop(); // events are counted as the file grows
+  if (!fFollowTimer) {
+    fFollowTimer = std::unique_ptr<TTimer>(new TTimer());
+    fFollowTimer->Connect("Timeout()", "jpet_event_display::EventDisplay",
+                          this, "checkFollowed()");
+  }
+  fFollowTimer->Start(static_cast<Long_t>(1000.0 / fFollowRefreshRate));
+  showNewestEvent();
+}
+
+void EventDisplay::stopFollowing()
+{
+  if (fFollowTimer)
+    fFollowTimer->Stop();
+  if (fFollowCheck)
+    fFollowCheck->SetState(kButtonUp);
+  dataProcessor->stopFollowing();
+}
+
+void EventDisplay::checkFollowed()
+{
+  if (dataProcessor->updateFollowed())
+    showNewestEvent();
+}
+
+void EventDisplay::showNewestEvent()
+{
+  long long numberOfEvents = dataProcessor->getNumberOfEvents();
+  if (numberOfEvents <= 0)
+    return;
+  setMaxProgressBar(numberOfEvents);
+  fNumberEntryEventNo->SetIntNumber(numberOfEvents - 1);
+  showData();
 }
 
-void EventDisplay::startVirtualization()
+/* Playback is driven by a timer, so the GUI keeps responding. Timer fires
+   twice per period of the target rate, events which became due while the
+   previous one was drawn are skipped, see PlaybackClock.
+*/
+void EventDisplay::startPlayback()
 {
-  startVirtualizationLoop(10);
+  if (!dataProcessor || dataProcessor->getNumberOfEvents() <= 0)
+    return;
+  if (!fPlaybackTimer) {
+    fPlaybackTimer = std::unique_ptr<TTimer>(new TTimer());
+    fPlaybackTimer->Connect("Timeout()", "jpet_event_display::EventDisplay",
+                            this, "playbackTick()");
+  }
+  updateGUIControlls();
+  if (!fPlaying && !fPlaybackPaused)
+    fPlaybackStartEvent = fGUIControls->eventNo;
+  double rate = fPlaybackRate->GetNumber();
+  fPlaybackClock.start(rate);
+  long intervalInMs = static_cast<long>(500. / rate);
+  fPlaybackTimer->Start(intervalInMs > 0 ? intervalInMs : 1);
+  fPlaying = true;
+  fPlaybackPaused = false;
+  updatePlaybackInfo("Playing");
 }
 
-void EventDisplay::startVirtualizationLoop(const int waitTimeInMs)
+void EventDisplay::pausePlayback()
 {
+  if (!fPlaying)
+    return;
+  fPlaybackTimer->Stop();
+  fPlaying = false;
+  fPlaybackPaused = true;
+  updatePlaybackInfo("Paused");
+}
+
+void EventDisplay::stopPlayback()
+{
+  if (fPlaybackTimer)
+    fPlaybackTimer->Stop();
+  fPlaying = false;
+  fPlaybackPaused = false;
+  fNumberEntryEventNo->SetIntNumber(fPlaybackStartEvent);
+  showData();
+  updatePlaybackInfo("Playback stopped");
+}
+
+void EventDisplay::changePlaybackRate()
+{
+  if (fPlaying)
+    startPlayback();
+}
+
+void EventDisplay::playbackTick()
+{
+  unsigned long long due = fPlaybackClock.advance();
+  if (due == 0)
+    return;
+  updateGUIControlls();
   long long maxEvent = dataProcessor->getNumberOfEvents();
-  for (int i = 0; i < 100 && fGUIControls->eventNo < maxEvent; i++) {
-    doNext();
-    std::this_thread::sleep_for(std::chrono::milliseconds(waitTimeInMs));
+  long long next = fGUIControls->eventNo +
+                   static_cast<long long>(due) * fGUIControls->stepNo;
+  if (next >= maxEvent) { // end of data, last event is shown
+    fPlaybackTimer->Stop();
+    fPlaying = false;
+    fPlaybackPaused = true; // stop still returns to the start event
+    next = maxEvent - 1;
+    if (next <= fGUIControls->eventNo) {
+      updatePlaybackInfo("End of data");
+      return;
+    }
   }
+  fNumberEntryEventNo->SetIntNumber(next);
+  showData();
+  if (fPlaybackClock.frameShown() || !fPlaying)
+    updatePlaybackInfo(fPlaying ? "Playing" : "End of data");
 }
 
+void EventDisplay::updatePlaybackInfo(const char* state)
+{
+  if (!fPlaybackInfo)
+    return;
+  std::ostringstream text;
+  text << state;
+  if (fPlaybackClock.getFramesPerSecond() > 0)
+    text << ", " << std::fixed << std::setprecision(1)
+         << fPlaybackClock.getFramesPerSecond() << " fps";
+  text << ", " << fPlaybackClock.getSkipped() << " skipped";
+  fPlaybackInfo->SetText(text.str().c_str());
+}
+
+// accumulation starts with the next shown event, which is read with hits
 void EventDisplay::checkBoxMarkersSignalFunction()
 {
   visualizator->changeMarkersState();
+  updateRequiredData();
+}
+
+void EventDisplay::checkBoxDensitySignalFunction()
+{
+  visualizator->changeDensityState();
+  updateRequiredData();
 }
 
 void EventDisplay::changeResetLeadingEdge()
 {
   dataProcessor->changeResetLeadingEdge();
 }
+
+void EventDisplay::timingSignalFunction()
+{
+  Profiler& profiler = Profiler::getInstance();
+  profiler.setEnabled(fTimingCheck->IsOn());
+  if (profiler.isEnabled())
+    profiler.reset(); // averages do not mix with the previous period
+  updateStatusBar();
+}
+
+/* Reading (readEntry), extraction (getDataForCurrentEvent) and drawing
+   (drawData, with updateCanvas redraws) are parts of showing event
+   (nthEvent and drawing).
+*/
+void EventDisplay::updateStatusBar()
+{
+  if (!fStatusBar)
+    return;
+  static const char* stages[] = {"nthEvent", "readEntry",
+                                 "getDataForCurrentEvent", "drawData",
+                                 "updateCanvas"
+                                };
+  Profiler& profiler = Profiler::getInstance();
+  for (int i = 0; i < 5; i++) {
+    std::ostringstream text;
+    double milliseconds = 0.;
+    if (!profiler.isEnabled())
+      text << (i == 0 ? "Timing disabled" : "");
+    else if (profiler.getAverage(stages[i], milliseconds))
+      text << stages[i] << " " << std::fixed << std::setprecision(2)
+           << milliseconds << " ms";
+    else
+      text << stages[i] << " -";
+    fStatusBar->SetText(text.str().c_str(), i);
+  }
+}
+
+/* Only data drawn on the selected tab is read from file and only this tab
+   is drawn, tabs are added in order of GeometryVisualizator views.
+*/
+void EventDisplay::changeView(Int_t tabNumber)
+{
+  if (tabNumber < 0 || tabNumber >= GeometryVisualizator::kNumberOfViews)
+    return;
+  visualizator->setActiveView(
+    static_cast<GeometryVisualizator::View>(tabNumber));
+  // shown event was read without data needed by the new view
+  if (updateRequiredData())
+    showData();
+  else
+    visualizator->updateActiveView();
+  updateStatusBar();
+}
+
+/* Returns true if data which was not read for the shown event is required
+   now.
+*/
+bool EventDisplay::updateRequiredData()
+{
+  unsigned int previous = dataProcessor->getRequiredData();
+  dataProcessor->setRequiredData(getRequiredData(
+                                   visualizator->getActiveView(),
+                                   visualizator->isAccumulating()));
+  return (dataProcessor->getRequiredData() & ~previous) != 0;
+}
+
+/* While markers or density are accumulated, hidden views with markers are
+   drawn for every shown event, so hits are read also on the diagram tab.
+*/
+unsigned int EventDisplay::getRequiredData(Int_t tabNumber, bool accumulating)
+{
+  if (tabNumber == GeometryVisualizator::kDiagramView)
+    return kStripData | kDiagramData | kInfoData |
+           (accumulating ? kHitData : 0);
+  return kStripData | kHitData | kInfoData;
+}
 } // namespace jpet_event_display
@@ -18,6 +18,7 @@
 
 #include <memory>
 #include <string>
+#include <vector>
 
 #include <TRint.h>
 
@@ -38,6 +39,7 @@
 #include <TMarker.h>
 #include <TRootEmbeddedCanvas.h>
 #include <TStyle.h>
+#include <TTimer.h>
 
 #include <RQ_OBJECT.h>
 
@@ -45,6 +47,7 @@
 #ifndef __ROOTCLING__
 #include "DataProcessor.h"
 #include "GeometryVisualizator.h"
+#include "PlaybackClock.h"
 
 #include <chrono>
 #include <thread>
@@ -75,9 +78,15 @@ public:
 
 #ifndef __CINT__
 #ifndef __ROOTCLING__
-  void run(std::shared_ptr<JPetGeomMapping> mapper, const int numberOfLayers,
+  void run(std::shared_ptr<JPetGeomMapping> mapper, const JPetParamBank& bank,
+           const int numberOfLayers,
            const int scintillatorLenght,
-           const std::vector<std::pair<int, double>>& layerStats);
+           const std::vector<std::pair<int, double>>& layerStats,
+           const size_t frameCacheSizeInMB = 64);
+  void setFollow(const std::string& path, double refreshRate);
+  void setProfiling(bool enabled, const std::string& traceFileName);
+  void setAccumulation(size_t capacity, double cellSize);
+  static unsigned int getRequiredData(Int_t tabNumber, bool accumulating);
   void createGUI();
   void drawSelectedStrips();
   void setMaxProgressBar(Int_t maxEvent);
@@ -105,9 +114,21 @@ public:
   void doNext();
   void doReset();
   void showData();
-  void startVirtualization();
+  void startPlayback();
+  void pausePlayback();
+  void stopPlayback();
+  void changePlaybackRate();
+  void playbackTick();
   void checkBoxMarkersSignalFunction();
+  void checkBoxDensitySignalFunction();
   void changeResetLeadingEdge();
+  void checkEventCount();
+  void startOccupancyScan();
+  void checkOccupancyScan();
+  void followSignalFunction();
+  void checkFollowed();
+  void changeView(Int_t tabNumber);
+  void timingSignalFunction();
 
 private:
 #ifndef __CINT__
@@ -137,7 +158,14 @@ private:
 
   void AddMenuBar(TGCompositeFrame* parentFrame);
 
-  void startVirtualizationLoop(const int waitTimeInMs = 1000);
+  std::vector<std::string> getSelectedFiles();
+
+  void updatePlaybackInfo(const char* state);
+  void startFollowing(const char* path);
+  void stopFollowing();
+  void showNewestEvent();
+  void updateStatusBar();
+  bool updateRequiredData();
 
   ULong_t fFrameBackgroundColor = 0;
 
@@ -155,6 +183,29 @@ private:
   std::unique_ptr<TGHProgressBar> fProgBar;
   std::unique_ptr<TGLabel> fInputInfo;
 
+  std::unique_ptr<TTimer> fEventCountTimer;
+  std::unique_ptr<TTimer> fOccupancyTimer;
+  std::unique_ptr<TTimer> fFollowTimer;
+  TGCheckButton* fFollowCheck = nullptr;
+  std::string fFollowPath;
+  double fFollowRefreshRate = 5.0; // in Hz
+
+  std::unique_ptr<TTimer> fPlaybackTimer;
+  PlaybackClock fPlaybackClock;
+  TGNumberEntry* fPlaybackRate = nullptr; // in events per second
+  TGLabel* fPlaybackInfo = nullptr;
+  Int_t fPlaybackStartEvent = 0; // shown again when playback is stopped
+  bool fPlaying = false;
+  bool fPlaybackPaused = false; // resumed playback keeps its start event
+
+  TGStatusBar* fStatusBar = nullptr;
+  TGCheckButton* fTimingCheck = nullptr;
+  std::string fTraceFileName;
+
+  // limits of markers saved between events, see PointAccumulator
+  size_t fAccumulationCapacity = PointAccumulator::kDefaultCapacity;
+  double fAccumulationCellSize = 0.;
+
   std::unique_ptr<TGFileInfo> fFileInfo =
     std::unique_ptr<TGFileInfo>(new TGFileInfo);
 #endif
@@ -0,0 +1,238 @@
+/**
+ *  @copyright Copyright 2016 The J-PET Framework Authors. All rights reserved.
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may find a copy of the License in the LICENCE file.
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *  @file EventIndex.cpp
+ */
+
+#include "./EventIndex.h"
+#include <JPetLoggerInclude.h>
+#include <JPetTimeWindow/JPetTimeWindow.h>
+#include <TFile.h>
+#include <TLeaf.h>
+#include <TSystem.h>
+#include <TTree.h>
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <memory>
+
+namespace jpet_event_display
+{
+
+// members of JPetTimeWindow holding number of events, in split trees they are
+// stored in separate branches and can be read without the events themselves
+const char* EventIndex::kEventCountLeaves[] = {"fEventCount", "fEvents_", 0};
+const char EventIndex::kMagic[8] = {'J', 'P', 'E', 'T', 'E', 'V', 'I', 'X'};
+
+EventIndex::EventIndex()
+{
+  clear();
+}
+
+void EventIndex::clear()
+{
+  fFirstEventInEntry.assign(1, 0);
+}
+
+void EventIndex::addEntry(unsigned int numberOfEventsInEntry)
+{
+  fFirstEventInEntry.push_back(fFirstEventInEntry.back() +
+                               numberOfEventsInEntry);
+}
+
+bool EventIndex::build(JPetReader& reader, const std::atomic<bool>* abort)
+{
+  clear();
+  long long numberOfEntries = reader.getNbOfAllEntries();
+  fFirstEventInEntry.reserve(numberOfEntries + 1);
+  for (long long i = 0; i < numberOfEntries; i++) {
+    if (abort && *abort) {
+      clear();
+      return false;
+    }
+    if (!reader.nthEntry(i)) {
+      ERROR("Could not read entry while building event index");
+      clear();
+      return false;
+    }
+    addEntry(dynamic_cast<JPetTimeWindow&>(reader.getCurrentEntry())
+             .getNumberOfEvents());
+  }
+  return true;
+}
+
+/* Counting pass used on a background thread. The file is opened separately
+   from the reader used for display, only the branch with number of events in
+   each time window is read. If the tree was stored without splitting, whole
+   time windows have to be read.
+*/
+bool EventIndex::buildFromEventCounts(const std::string& dataFileName,
+                                      const std::atomic<bool>& abort)
+{
+  clear();
+  std::unique_ptr<TFile> file(TFile::Open(dataFileName.c_str(), "READ"));
+  if (!file || file->IsZombie()) {
+    ERROR("Could not open file for counting events: " + dataFileName);
+    return false;
+  }
+  TTree* tree = dynamic_cast<TTree*>(file->Get("tree"));
+  if (!tree) {
+    ERROR("No tree in file: " + dataFileName);
+    return false;
+  }
+  TLeaf* countLeaf = 0;
+  for (int i = 0; kEventCountLeaves[i] && !countLeaf; i++) {
+    countLeaf = tree->FindLeaf(kEventCountLeaves[i]);
+  }
+  if (!countLeaf) {
+    file->Close();
+    INFO("No event count branch in tree, reading whole time windows");
+    JPetReader reader;
+    if (!reader.openFileAndLoadData(dataFileName.c_str()))
+      return false;
+    bool result = build(reader, &abort);
+    reader.closeFile();
+    return result;
+  }
+  TBranch* countBranch = countLeaf->GetBranch();
+  long long numberOfEntries = tree->GetEntries();
+  fFirstEventInEntry.reserve(numberOfEntries + 1);
+  for (long long i = 0; i < numberOfEntries; i++) {
+    if (abort) {
+      clear();
+      return false;
+    }
+    if (countBranch->GetEntry(i) < 0) {
+      ERROR("Could not read number of events in entry");
+      clear();
+      return false;
+    }
+    addEntry(static_cast<unsigned int>(countLeaf->GetValue()));
+  }
+  file->Close();
+  return true;
+}
+
+bool EventIndex::findEvent(long long eventNumber, long long& entry,
+                           unsigned int& eventInEntry) const
+{
+  if (eventNumber < 0 || eventNumber >= getNumberOfEvents())
+    return false;
+  // first entry which starts after searched event, event is in the previous one
+  auto it = std::upper_bound(fFirstEventInEntry.begin(),
+                             fFirstEventInEntry.end(), eventNumber);
+  entry = (it - fFirstEventInEntry.begin()) - 1;
+  eventInEntry = static_cast<unsigned int>(eventNumber - *(it - 1));
+  return true;
+}
+
+std::string EventIndex::getIndexFileName(const std::string& dataFileName)
+{
+  return dataFileName + ".evtidx";
+}
+
+bool EventIndex::getDataFileStamp(const std::string& dataFileName,
+                                  long long& size, long long& modTime)
+{
+  Long_t id = 0, flags = 0, modificationTime = 0;
+  Long64_t fileSize = 0;
+  if (gSystem->GetPathInfo(dataFileName.c_str(), &id, &fileSize, &flags,
+                           &modificationTime) != 0)
+    return false;
+  size = fileSize;
+  modTime = modificationTime;
+  return true;
+}
+
+/* Index file layout (native endianness):
+   magic[8], version(uint32), data file size(int64), data file mtime(int64),
+   number of entries(int64), prefix sums(int64 * (number of entries + 1))
+*/
+bool EventIndex::save(const std::string& dataFileName) const
+{
+  long long size = 0, modTime = 0;
+  if (!getDataFileStamp(dataFileName, size, modTime))
+    return false;
+  std::ofstream out(getIndexFileName(dataFileName).c_str(),
+                    std::ios_base::out | std::ios_base::binary);
+  if (!out) {
+    WARNING("Could not create event index file, index will not be saved");
+    return false;
+  }
+  unsigned int version = kVersion;
+  long long numberOfEntries = getNumberOfEntries();
+  out.write(kMagic, sizeof(kMagic));
+  out.write(reinterpret_cast<const char*>(&version), sizeof(version));
+  out.write(reinterpret_cast<const char*>(&size), sizeof(size));
+  out.write(reinterpret_cast<const char*>(&modTime), sizeof(modTime));
+  out.write(reinterpret_cast<const char*>(&numberOfEntries),
+            sizeof(numberOfEntries));
+  out.write(reinterpret_cast<const char*>(fFirstEventInEntry.data()),
+            fFirstEventInEntry.size() * sizeof(long long));
+  return static_cast<bool>(out);
+}
+
+/* Negative numberOfEntries means it is not known (data file is not opened),
+   number saved in the index file is taken then.
+*/
+bool EventIndex::load(const std::string& dataFileName,
+                      long long numberOfEntries)
+{
+  long long size = 0, modTime = 0;
+  if (!getDataFileStamp(dataFileName, size, modTime))
+    return false;
+  std::ifstream in(getIndexFileName(dataFileName).c_str(),
+                   std::ios_base::in | std::ios_base::binary);
+  if (!in)
+    return false;
+  char magic[sizeof(kMagic)];
+  unsigned int version = 0;
+  long long savedSize = 0, savedModTime = 0, savedNumberOfEntries = 0;
+  in.read(magic, sizeof(magic));
+  in.read(reinterpret_cast<char*>(&version), sizeof(version));
+  in.read(reinterpret_cast<char*>(&savedSize), sizeof(savedSize));
+  in.read(reinterpret_cast<char*>(&savedModTime), sizeof(savedModTime));
+  in.read(reinterpret_cast<char*>(&savedNumberOfEntries),
+          sizeof(savedNumberOfEntries));
+  if (numberOfEntries < 0)
+    numberOfEntries = savedNumberOfEntries;
+  if (!in || std::memcmp(magic, kMagic, sizeof(kMagic)) != 0 ||
+      version != kVersion || savedSize != size || savedModTime != modTime ||
+      savedNumberOfEntries != numberOfEntries || numberOfEntries < 0) {
+    WARNING("Event index file is outdated, it will be rebuilt");
+    return false;
+  }
+  // number of entries is checked against size of the index file before
+  // allocating, a corrupted header could ask for any amount of memory
+  std::streamoff headerSize = in.tellg();
+  in.seekg(0, std::ios_base::end);
+  std::streamoff indexFileSize = in.tellg();
+  in.seekg(headerSize);
+  std::streamoff savedValues =
+    (indexFileSize - headerSize) / static_cast<std::streamoff>(sizeof(long long));
+  if (!in || savedValues < 1 ||
+      (indexFileSize - headerSize) % sizeof(long long) != 0 ||
+      savedValues - 1 != numberOfEntries) {
+    WARNING("Event index file is corrupted, it will be rebuilt");
+    return false;
+  }
+  std::vector<long long> firstEventInEntry(numberOfEntries + 1);
+  in.read(reinterpret_cast<char*>(firstEventInEntry.data()),
+          firstEventInEntry.size() * sizeof(long long));
+  if (!in || firstEventInEntry.front() != 0) {
+    WARNING("Event index file is corrupted, it will be rebuilt");
+    return false;
+  }
+  fFirstEventInEntry.swap(firstEventInEntry);
+  return true;
+}
+} // namespace jpet_event_display
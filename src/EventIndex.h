@@ -0,0 +1,76 @@
+/**
+ *  @copyright Copyright 2016 The J-PET Framework Authors. All rights reserved.
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may find a copy of the License in the LICENCE file.
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *  @brief Index mapping global event number to time window entry.
+ */
+
+#ifndef EVENTINDEX_H
+#define EVENTINDEX_H
+
+#include <atomic>
+#include <string>
+#include <vector>
+
+#ifndef __CINT__
+#ifndef __ROOTCLING__
+#include <JPetReader/JPetReader.h>
+#endif
+#endif
+
+namespace jpet_event_display
+{
+/* Prefix sum of number of events in each time window of the file.
+   fFirstEventInEntry[i] is the global number of the first event stored in
+   entry i, last element is the number of all events in the file. Index is
+   saved next to the data file (see getIndexFileName) so it is built only
+   once per file.
+*/
+class EventIndex
+{
+public:
+  EventIndex();
+
+  void clear();
+  void addEntry(unsigned int numberOfEventsInEntry);
+  bool build(JPetReader& reader, const std::atomic<bool>* abort = nullptr);
+  bool buildFromEventCounts(const std::string& dataFileName,
+                            const std::atomic<bool>& abort);
+  bool load(const std::string& dataFileName, long long numberOfEntries);
+  bool save(const std::string& dataFileName) const;
+
+  bool findEvent(long long eventNumber, long long& entry,
+                 unsigned int& eventInEntry) const;
+
+  inline long long getNumberOfEvents() const
+  {
+    return fFirstEventInEntry.back();
+  }
+  inline long long getNumberOfEntries() const
+  {
+    return static_cast<long long>(fFirstEventInEntry.size()) - 1;
+  }
+
+  static std::string getIndexFileName(const std::string& dataFileName);
+
+private:
+  static bool getDataFileStamp(const std::string& dataFileName,
+                               long long& size, long long& modTime);
+
+  static const char* kEventCountLeaves[];
+  static const char kMagic[8];
+  static const unsigned int kVersion = 1;
+
+  std::vector<long long> fFirstEventInEntry;
+};
+} // namespace jpet_event_display
+
+#endif /*  !EVENTINDEX_H */
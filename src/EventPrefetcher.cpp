@@ -0,0 +1,129 @@
+/**
+ *  @copyright Copyright 2016 The J-PET Framework Authors. All rights reserved.
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may find a copy of the License in the LICENCE file.
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *  @file EventPrefetcher.cpp
+ */
+
+#include "./EventPrefetcher.h"
+#include <JPetLoggerInclude.h>
+
+namespace jpet_event_display
+{
+
+EventPrefetcher::EventPrefetcher(
+  std::shared_ptr<JPetGeomMapping> mapper,
+  std::shared_ptr<const StripPosTable> stripPositions,
+  const std::string& fileName, const EventIndex& index,
+  bool resetLeadingEdge, unsigned int requiredData)
+  : fDecoder(mapper, stripPositions), fFileName(fileName), fIndex(index),
+    fRequiredData(requiredData)
+{
+  fDecoder.setResetLeadingEdge(resetLeadingEdge);
+  fDecoder.setRequiredData(requiredData);
+  fThread = std::thread(&EventPrefetcher::run, this);
+}
+
+EventPrefetcher::~EventPrefetcher()
+{
+  {
+    std::lock_guard<std::mutex> lock(fMutex);
+    fStop = true;
+  }
+  fCondition.notify_one();
+  if (fThread.joinable())
+    fThread.join();
+}
+
+/* Replaces previous request, frames which are not in the new one are
+   dropped. Events already decoded or being decoded are not queued again.
+*/
+void EventPrefetcher::request(long long firstEvent, long long step,
+                              unsigned int numberOfEvents)
+{
+  {
+    std::lock_guard<std::mutex> lock(fMutex);
+    fPending.clear();
+    fWanted.clear();
+    for (unsigned int i = 0; i < numberOfEvents; i++) {
+      long long eventNumber = firstEvent + i * step;
+      if (eventNumber < 0 || eventNumber >= fIndex.getNumberOfEvents())
+        break;
+      fWanted.insert(eventNumber);
+      if (eventNumber != fDecodedEvent && fReady.count(eventNumber) == 0)
+        fPending.push_back(eventNumber);
+    }
+    for (auto it = fReady.begin(); it != fReady.end();) {
+      if (fWanted.count(it->first) == 0)
+        it = fReady.erase(it);
+      else
+        ++it;
+    }
+  }
+  fCondition.notify_one();
+}
+
+/* Does not wait for a frame which is being decoded, the caller decodes it
+   itself, so the GUI thread is never blocked by the worker.
+*/
+bool EventPrefetcher::takeFrame(long long eventNumber, DisplayFrame& frame)
+{
+  std::lock_guard<std::mutex> lock(fMutex);
+  auto it = fReady.find(eventNumber);
+  if (it == fReady.end())
+    return false;
+  frame = std::move(it->second);
+  fReady.erase(it);
+  return true;
+}
+
+// frames decoded with the previous data are dropped, file is not reopened
+void EventPrefetcher::setRequiredData(unsigned int requiredData)
+{
+  std::lock_guard<std::mutex> lock(fMutex);
+  if (requiredData == fRequiredData)
+    return;
+  fRequiredData = requiredData;
+  fPending.clear();
+  fWanted.clear();
+  fReady.clear();
+}
+
+void EventPrefetcher::run()
+{
+  if (!fDecoder.openFile(fFileName.c_str(), fIndex)) {
+    ERROR("Could not open file for prefetching: " + fFileName);
+    return;
+  }
+  std::unique_lock<std::mutex> lock(fMutex);
+  while (true) {
+    fCondition.wait(lock, [this]() {
+      return fStop || !fPending.empty();
+    });
+    if (fStop)
+      break;
+    fDecodedEvent = fPending.front();
+    fPending.pop_front();
+    unsigned int requiredData = fRequiredData;
+    lock.unlock();
+    fDecoder.setRequiredData(requiredData);
+    DisplayFrame frame;
+    bool decoded = fDecoder.decodeEvent(fDecodedEvent, frame);
+    lock.lock();
+    if (decoded && requiredData == fRequiredData &&
+        fWanted.count(fDecodedEvent) > 0)
+      fReady[fDecodedEvent] = std::move(frame);
+    fDecodedEvent = -1;
+  }
+  lock.unlock();
+  fDecoder.closeFile();
+}
+} // namespace jpet_event_display
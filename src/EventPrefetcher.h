@@ -0,0 +1,72 @@
+/**
+ *  @copyright Copyright 2016 The J-PET Framework Authors. All rights reserved.
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may find a copy of the License in the LICENCE file.
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *  @brief Decodes events which will be shown next on a worker thread.
+ */
+
+#ifndef EVENTPREFETCHER_H
+#define EVENTPREFETCHER_H
+
+#include <condition_variable>
+#include <deque>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <string>
+#include <thread>
+
+#include "DataProcessor.h"
+
+namespace jpet_event_display
+{
+/* Worker owns separate DataProcessor with its own reader, so decoding does
+   not interfere with the reader used by GUI thread. Frames are decoded in
+   the order of request and kept until they are taken or not wanted anymore.
+*/
+class EventPrefetcher
+{
+public:
+  EventPrefetcher(std::shared_ptr<JPetGeomMapping> mapper,
+                  std::shared_ptr<const StripPosTable> stripPositions,
+                  const std::string& fileName, const EventIndex& index,
+                  bool resetLeadingEdge, unsigned int requiredData);
+  ~EventPrefetcher();
+
+  void request(long long firstEvent, long long step,
+               unsigned int numberOfEvents);
+  bool takeFrame(long long eventNumber, DisplayFrame& frame);
+  void setRequiredData(unsigned int requiredData);
+
+private:
+  EventPrefetcher(const EventPrefetcher&) = delete;
+  EventPrefetcher& operator=(const EventPrefetcher&) = delete;
+
+  void run();
+
+  DataProcessor fDecoder;
+  std::string fFileName;
+  EventIndex fIndex;
+
+  std::mutex fMutex;
+  std::condition_variable fCondition;
+  bool fStop = false;
+  unsigned int fRequiredData; // applied to fDecoder by the worker
+  long long fDecodedEvent = -1;
+  std::deque<long long> fPending;
+  std::set<long long> fWanted;
+  std::map<long long, DisplayFrame> fReady;
+  std::thread fThread;
+};
+} // namespace jpet_event_display
+
+#endif /*  !EVENTPREFETCHER_H */
@@ -0,0 +1,96 @@
+/**
+ *  @copyright Copyright 2016 The J-PET Framework Authors. All rights reserved.
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may find a copy of the License in the LICENCE file.
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *  @file EventReader.cpp
+ */
+
+#include "./EventReader.h"
+#include <TBranch.h>
+#include <TObjArray.h>
+#include <TTree.h>
+
+namespace jpet_event_display
+{
+
+/* Re-reads header of the tree from the file, so entries flushed by the
+   writer since the file was opened become readable. The tree is updated in
+   place, branch addresses and the current entry are kept. Returns number
+   of entries in the tree.
+*/
+long long EventReader::refresh()
+{
+  if (!fTree)
+    return 0;
+  fTree->Refresh();
+  return fTree->GetEntries();
+}
+
+/* Objects stored with splitting have a branch per member, named with the
+   path of members, e.g. fEvents.fHits.fSignalA. Branches of given members
+   (with all their sub-branches) are disabled, so their baskets are neither
+   read nor decompressed. Members of objects stored without splitting are
+   always read. Previous selection is replaced, returns number of disabled
+   branches.
+*/
+int EventReader::skipMembers(const std::vector<std::string>& members)
+{
+  if (!fTree)
+    return 0;
+  fTree->SetBranchStatus("*", 1);
+  int disabled = members.empty()
+                 ? 0 : disableBranches(fTree->GetListOfBranches(), members);
+  // current entry is read again, with newly enabled members
+  long long current = getCurrentEntryNumber();
+  if (current >= 0)
+    nthEntry(current);
+  return disabled;
+}
+
+int EventReader::disableBranches(TObjArray* branches,
+                                 const std::vector<std::string>& members)
+{
+  int disabled = 0;
+  for (int i = 0; branches && i < branches->GetEntriesFast(); i++) {
+    TBranch* branch = static_cast<TBranch*>(branches->UncheckedAt(i));
+    std::string name = branch->GetName();
+    bool skipped = false;
+    for (const std::string& member : members)
+      skipped = skipped || isMemberBranch(name, member);
+    if (skipped) {
+      fTree->SetBranchStatus(name.c_str(), 0);
+      disabled++;
+    } else {
+      disabled += disableBranches(branch->GetListOfBranches(), members);
+    }
+  }
+  return disabled;
+}
+
+// member has to be a whole component of the branch name
+bool EventReader::isMemberBranch(const std::string& branchName,
+                                 const std::string& member)
+{
+  if (member.empty())
+    return false;
+  for (size_t position = branchName.find(member);
+       position != std::string::npos;
+       position = branchName.find(member, position + 1)) {
+    size_t end = position + member.size();
+    bool atStart = position == 0 || branchName[position - 1] == '.';
+    bool atEnd = end == branchName.size() || branchName[end] == '.' ||
+                 branchName[end] == '[';
+    if (atStart && atEnd)
+      return true;
+  }
+  return false;
+}
+} // namespace jpet_event_display
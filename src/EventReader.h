@@ -0,0 +1,57 @@
+/**
+ *  @copyright Copyright 2016 The J-PET Framework Authors. All rights reserved.
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may find a copy of the License in the LICENCE file.
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *  @brief JPetReader with access to the tree of time windows.
+ */
+
+#ifndef EVENTREADER_H
+#define EVENTREADER_H
+
+#ifndef __CINT__
+#ifndef __ROOTCLING__
+#include <JPetReader/JPetReader.h>
+#endif
+#endif
+
+#include <string>
+#include <vector>
+
+class TObjArray;
+class TTree;
+
+namespace jpet_event_display
+{
+/* JPetReader keeps the tree protected. Event display needs it to follow
+   files which are still being written by DAQ and to read only the members
+   of stored objects which are drawn.
+*/
+class EventReader : public JPetReader
+{
+public:
+  long long refresh();
+  int skipMembers(const std::vector<std::string>& members);
+
+  static bool isMemberBranch(const std::string& branchName,
+                             const std::string& member);
+
+  inline TTree* getTree() const
+  {
+    return fTree;
+  }
+
+private:
+  int disableBranches(TObjArray* branches,
+                      const std::vector<std::string>& members);
+};
+} // namespace jpet_event_display
+
+#endif /*  !EVENTREADER_H */
@@ -0,0 +1,202 @@
+/**
+ *  @copyright Copyright 2016 The J-PET Framework Authors. All rights reserved.
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may find a copy of the License in the LICENCE file.
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *  @file FileChain.cpp
+ */
+
+#include "./FileChain.h"
+#include <JPetLoggerInclude.h>
+#include <TRegexp.h>
+#include <TString.h>
+#include <TSystem.h>
+#include <algorithm>
+#include <fstream>
+#include <sstream>
+
+namespace jpet_event_display
+{
+
+FileChain::FileChain(const std::vector<std::string>& fileNames)
+  : fFileNames(fileNames), fIndices(fileNames.size()),
+    fCounted(fileNames.size(), false)
+{
+  for (size_t i = 0; i < fFileNames.size(); i++) {
+    if (fIndices[i].load(fFileNames[i], -1)) {
+      fCounted[i] = true;
+      fNumberOfCountedFiles++;
+    }
+  }
+}
+
+FileChain::~FileChain()
+{
+  stopCounting();
+}
+
+void FileChain::startCounting()
+{
+  stopCounting();
+  if (isComplete())
+    return;
+  fStopCounting = false;
+  fCountingThread = std::thread([this]() {
+    for (size_t i = 0; i < fFileNames.size() && !fStopCounting; i++)
+      count(i);
+  });
+}
+
+void FileChain::stopCounting()
+{
+  fStopCounting = true;
+  if (fCountingThread.joinable())
+    fCountingThread.join();
+}
+
+bool FileChain::waitForCounting()
+{
+  if (fCountingThread.joinable())
+    fCountingThread.join();
+  return isComplete();
+}
+
+/* Builds and saves index of the file if there was no saved one. File
+   which cannot be read is counted as empty, so the chain is completed.
+*/
+void FileChain::count(size_t file)
+{
+  {
+    std::lock_guard<std::mutex> lock(fMutex);
+    if (fCounted[file])
+      return;
+  }
+  EventIndex index;
+  if (index.buildFromEventCounts(fFileNames[file], fStopCounting)) {
+    index.save(fFileNames[file]);
+  } else if (fStopCounting) {
+    return;
+  } else {
+    ERROR("Could not count events in file, it is skipped: " + fFileNames[file]);
+    index.clear();
+  }
+  std::lock_guard<std::mutex> lock(fMutex);
+  fIndices[file] = index;
+  fCounted[file] = true;
+  fNumberOfCountedFiles++;
+}
+
+/* Files are not counted here, it would block the caller. When a file
+   before the one with searched event is not counted yet, kNotCountedYet is
+   returned and the search should be repeated later.
+*/
+FileChain::FindResult FileChain::findEvent(long long eventNumber, size_t& file,
+    long long& eventInFile)
+{
+  if (eventNumber < 0)
+    return kNotFound;
+  std::lock_guard<std::mutex> lock(fMutex);
+  for (size_t i = 0; i < fFileNames.size(); i++) {
+    if (!fCounted[i])
+      return kNotCountedYet;
+    long long numberOfEvents = fIndices[i].getNumberOfEvents();
+    if (eventNumber < numberOfEvents) {
+      file = i;
+      eventInFile = eventNumber;
+      return kFound;
+    }
+    eventNumber -= numberOfEvents;
+  }
+  return kNotFound;
+}
+
+// index of a file which is not counted yet is empty
+EventIndex FileChain::getIndex(size_t file)
+{
+  std::lock_guard<std::mutex> lock(fMutex);
+  return fCounted[file] ? fIndices[file] : EventIndex();
+}
+
+// sum of events in already counted files
+long long FileChain::getNumberOfEvents()
+{
+  std::lock_guard<std::mutex> lock(fMutex);
+  long long numberOfEvents = 0;
+  for (size_t i = 0; i < fIndices.size(); i++) {
+    if (fCounted[i])
+      numberOfEvents += fIndices[i].getNumberOfEvents();
+  }
+  return numberOfEvents;
+}
+
+/* Accepts a wildcard pattern in the file name (e.g. run_*.root, files are
+   sorted by name), a text file with one data file name per line (.txt or
+   .list) or a comma separated list of files. Existing file is never split,
+   even if its name contains commas.
+*/
+std::vector<std::string> FileChain::expandFileNames(const std::string& pattern)
+{
+  std::vector<std::string> fileNames;
+  size_t slash = pattern.find_last_of('/');
+  std::string directory =
+    slash == std::string::npos ? "." : pattern.substr(0, slash);
+  std::string baseName =
+    slash == std::string::npos ? pattern : pattern.substr(slash + 1);
+
+  if (baseName.find_first_of("*?[") != std::string::npos) {
+    TRegexp wildcard(baseName.c_str(), kTRUE);
+    void* dir = gSystem->OpenDirectory(directory.c_str());
+    if (!dir) {
+      ERROR("Could not open directory: " + directory);
+      return fileNames;
+    }
+    while (const char* entry = gSystem->GetDirEntry(dir)) {
+      TString name(entry);
+      Ssiz_t length = 0;
+      if (name.Index(wildcard, &length) == 0 && length == name.Length())
+        fileNames.push_back(slash == std::string::npos
+                            ? std::string(entry)
+                            : directory + "/" + entry);
+    }
+    gSystem->FreeDirectory(dir);
+    std::sort(fileNames.begin(), fileNames.end());
+    return fileNames;
+  }
+
+  auto endsWith = [&pattern](const std::string & end) {
+    return pattern.size() > end.size() &&
+           pattern.compare(pattern.size() - end.size(), end.size(), end) == 0;
+  };
+  if (endsWith(".txt") || endsWith(".list")) {
+    std::ifstream list(pattern.c_str());
+    std::string line;
+    while (std::getline(list, line)) {
+      line.erase(0, line.find_first_not_of(" \t"));
+      line.erase(line.find_last_not_of(" \t\r") + 1);
+      if (!line.empty() && line[0] != '#')
+        fileNames.push_back(line);
+    }
+    return fileNames;
+  }
+
+  // file name can contain commas, list is split only if there is no such file
+  if (!gSystem->AccessPathName(pattern.c_str())) {
+    fileNames.push_back(pattern);
+    return fileNames;
+  }
+  std::istringstream in(pattern);
+  std::string fileName;
+  while (std::getline(in, fileName, ',')) {
+    if (!fileName.empty())
+      fileNames.push_back(fileName);
+  }
+  return fileNames;
+}
+} // namespace jpet_event_display
@@ -0,0 +1,89 @@
+/**
+ *  @copyright Copyright 2016 The J-PET Framework Authors. All rights reserved.
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may find a copy of the License in the LICENCE file.
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *  @brief List of data files shown as one dataset with global event numbers.
+ */
+
+#ifndef FILECHAIN_H
+#define FILECHAIN_H
+
+#include <atomic>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "EventIndex.h"
+
+namespace jpet_event_display
+{
+/* Events of all files are numbered one after another, in order of files.
+   Number of events in a file is taken from its saved event index, so
+   finding a file with given event does not open data files before it.
+   Files without saved index are counted (and their index saved) on a
+   background thread, in order of files. Files which could not be counted
+   are shown as having no events.
+*/
+class FileChain
+{
+public:
+  enum FindResult {
+    kFound,
+    kNotFound,
+    kNotCountedYet // file with the event is not known until more are counted
+  };
+
+  explicit FileChain(const std::vector<std::string>& fileNames);
+  ~FileChain();
+
+  void startCounting();
+  void stopCounting();
+  bool waitForCounting();
+
+  FindResult findEvent(long long eventNumber, size_t& file,
+                       long long& eventInFile);
+  EventIndex getIndex(size_t file);
+  long long getNumberOfEvents();
+
+  inline bool isComplete() const
+  {
+    return fNumberOfCountedFiles == fFileNames.size();
+  }
+  inline size_t getNumberOfFiles() const
+  {
+    return fFileNames.size();
+  }
+  inline const std::string& getFileName(size_t file) const
+  {
+    return fFileNames[file];
+  }
+
+  static std::vector<std::string> expandFileNames(const std::string& pattern);
+
+private:
+  FileChain(const FileChain&) = delete;
+  FileChain& operator=(const FileChain&) = delete;
+
+  void count(size_t file);
+
+  std::vector<std::string> fFileNames;
+  std::vector<EventIndex> fIndices;
+  std::vector<bool> fCounted;
+  std::mutex fMutex; // guards fIndices and fCounted
+  std::atomic<size_t> fNumberOfCountedFiles {0};
+
+  std::thread fCountingThread;
+  std::atomic<bool> fStopCounting {false};
+};
+} // namespace jpet_event_display
+
+#endif /*  !FILECHAIN_H */
@@ -0,0 +1,71 @@
+/**
+ *  @copyright Copyright 2016 The J-PET Framework Authors. All rights reserved.
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may find a copy of the License in the LICENCE file.
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *  @file FrameCache.cpp
+ */
+
+#include "./FrameCache.h"
+
+namespace jpet_event_display
+{
+
+FrameCache::FrameCache(size_t memoryBudget) : fMemoryBudget(memoryBudget) {}
+
+bool FrameCache::get(long long eventNumber, DisplayFrame& frame)
+{
+  auto position = fPositions.find(eventNumber);
+  if (position == fPositions.end())
+    return false;
+  fFrames.splice(fFrames.begin(), fFrames, position->second);
+  frame = position->second->frame;
+  return true;
+}
+
+void FrameCache::put(long long eventNumber, const DisplayFrame& frame)
+{
+  auto position = fPositions.find(eventNumber);
+  if (position != fPositions.end()) {
+    fMemoryUsage -= position->second->size;
+    fFrames.erase(position->second);
+    fPositions.erase(position);
+  }
+  size_t size = frame.getMemorySize();
+  if (size > fMemoryBudget)
+    return;
+  fFrames.push_front(CachedFrame {eventNumber, size, frame});
+  fPositions[eventNumber] = fFrames.begin();
+  fMemoryUsage += size;
+  evict();
+}
+
+void FrameCache::clear()
+{
+  fFrames.clear();
+  fPositions.clear();
+  fMemoryUsage = 0;
+}
+
+void FrameCache::setMemoryBudget(size_t memoryBudget)
+{
+  fMemoryBudget = memoryBudget;
+  evict();
+}
+
+void FrameCache::evict()
+{
+  while (fMemoryUsage > fMemoryBudget && !fFrames.empty()) {
+    fMemoryUsage -= fFrames.back().size;
+    fPositions.erase(fFrames.back().eventNumber);
+    fFrames.pop_back();
+  }
+}
+} // namespace jpet_event_display
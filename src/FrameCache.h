@@ -0,0 +1,70 @@
+/**
+ *  @copyright Copyright 2016 The J-PET Framework Authors. All rights reserved.
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may find a copy of the License in the LICENCE file.
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *  @brief Least recently used cache of decoded display frames.
+ */
+
+#ifndef FRAMECACHE_H
+#define FRAMECACHE_H
+
+#include <list>
+#include <unordered_map>
+
+#include "DataProcessor.h"
+
+namespace jpet_event_display
+{
+/* Frames are kept by global event number. When memory taken by frames
+   exceeds the budget, least recently used ones are removed.
+*/
+class FrameCache
+{
+public:
+  static const size_t kDefaultMemoryBudget = 64 * 1024 * 1024;
+
+  explicit FrameCache(size_t memoryBudget = kDefaultMemoryBudget);
+
+  bool get(long long eventNumber, DisplayFrame& frame);
+  void put(long long eventNumber, const DisplayFrame& frame);
+  void clear();
+
+  void setMemoryBudget(size_t memoryBudget);
+  inline size_t getMemoryBudget() const
+  {
+    return fMemoryBudget;
+  }
+  inline size_t getMemoryUsage() const
+  {
+    return fMemoryUsage;
+  }
+  inline size_t getNumberOfFrames() const
+  {
+    return fFrames.size();
+  }
+
+private:
+  struct CachedFrame {
+    long long eventNumber;
+    size_t size;
+    DisplayFrame frame;
+  };
+
+  void evict();
+
+  size_t fMemoryBudget = kDefaultMemoryBudget;
+  size_t fMemoryUsage = 0;
+  std::list<CachedFrame> fFrames; // most recently used first
+  std::unordered_map<long long, std::list<CachedFrame>::iterator> fPositions;
+};
+} // namespace jpet_event_display
+
+#endif /*  !FRAMECACHE_H */
@@ -0,0 +1,55 @@
+/**
+ *  @copyright Copyright 2016 The J-PET Framework Authors. All rights reserved.
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may find a copy of the License in the LICENCE file.
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *  @file FramePrimitives.cpp
+ */
+
+#include "./FramePrimitives.h"
+
+namespace jpet_event_display
+{
+void FramePrimitives::release()
+{
+  for (auto& pool : fPools)
+    pool.second.used = 0;
+  fInUse.clear();
+}
+
+/* Adds this object to the pad once, later frames are painted by the same
+   entry. The pad must not be cleared while primitives are shown.
+*/
+void FramePrimitives::drawOn(TVirtualPad* pad)
+{
+  if (!pad || pad == fPad)
+    return;
+  TVirtualPad* previous = gPad;
+  pad->cd();
+  Draw();
+  if (previous)
+    previous->cd();
+  fPad = pad;
+}
+
+void FramePrimitives::Paint(Option_t*)
+{
+  for (TObject* object : fInUse)
+    object->Paint();
+}
+
+size_t FramePrimitives::getNumberOfAllocated() const
+{
+  size_t allocated = 0;
+  for (const auto& pool : fPools)
+    allocated += pool.second.objects.size();
+  return allocated;
+}
+} // namespace jpet_event_display
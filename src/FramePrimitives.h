@@ -0,0 +1,102 @@
+/**
+ *  @copyright Copyright 2016 The J-PET Framework Authors. All rights reserved.
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may find a copy of the License in the LICENCE file.
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *  @brief Owner of drawing primitives of a frame, recycled between events.
+ */
+
+#ifndef FRAMEPRIMITIVES_H
+#define FRAMEPRIMITIVES_H
+
+#include <TObject.h>
+#include <TPolyLine.h>
+#include <TPolyLine3D.h>
+#include <TPolyMarker.h>
+#include <TPolyMarker3D.h>
+#include <TVirtualPad.h>
+#include <map>
+#include <memory>
+#include <typeindex>
+#include <typeinfo>
+#include <vector>
+
+namespace jpet_event_display
+{
+/* Primitives of a frame (markers, lines) are created with create<T>() and
+   painted by this object, which is the only entry in the list of
+   primitives of the pad. release() returns all of them to per-type pools at
+   once, without searching the pad, and next create<T>() reuses them, so
+   number of allocated objects is bounded by the biggest frame. Objects are
+   owned by the pools, callers must not delete them.
+*/
+class FramePrimitives : public TObject
+{
+public:
+  FramePrimitives() {}
+
+  template <class T>
+  T* create()
+  {
+    Pool& pool = fPools[std::type_index(typeid(T))];
+    if (pool.used == pool.objects.size())
+      pool.objects.emplace_back(new T());
+    T* object = static_cast<T*>(pool.objects[pool.used++].get());
+    reset(*object);
+    fInUse.push_back(object);
+    return object;
+  }
+
+  void release();
+  void drawOn(TVirtualPad* pad);
+  void Paint(Option_t* option = "") override;
+
+  inline size_t size() const
+  {
+    return fInUse.size();
+  }
+  size_t getNumberOfAllocated() const;
+
+private:
+  FramePrimitives(const FramePrimitives&) = delete;
+  FramePrimitives& operator=(const FramePrimitives&) = delete;
+
+  // recycled object is brought back to state after default construction
+  static void reset(TObject&) {}
+  static void reset(TPolyLine& line)
+  {
+    line.SetPolyLine(0);
+  }
+  static void reset(TPolyMarker& marker)
+  {
+    marker.SetPolyMarker(0);
+  }
+  static void reset(TPolyLine3D& line)
+  {
+    line.SetPolyLine(0);
+  }
+  static void reset(TPolyMarker3D& marker)
+  {
+    marker.SetPolyMarker(0, static_cast<Float_t*>(nullptr),
+                         marker.GetMarkerStyle());
+  }
+
+  struct Pool {
+    std::vector<std::unique_ptr<TObject>> objects;
+    size_t used = 0;
+  };
+
+  std::map<std::type_index, Pool> fPools;
+  std::vector<TObject*> fInUse; // in order of creation, painted in this order
+  TVirtualPad* fPad = nullptr;
+};
+} // namespace jpet_event_display
+
+#endif /*  !FRAMEPRIMITIVES_H */
@@ -14,13 +14,16 @@
  */
 
 #include "GeometryVisualizator.h"
+#include "StageTimer.h"
 #include <JPetLoggerInclude.h>
+#include <algorithm>
 #include <limits>
 #include <TCanvas.h>
 #include <TFile.h>
 
 #include <TPolyLine3D.h>
 #include <TRandom.h>
+#include <TStyle.h>
 #include <memory>
 
 namespace jpet_event_display
@@ -36,19 +39,77 @@ GeometryVisualizator::GeometryVisualizator(
 
 GeometryVisualizator::~GeometryVisualizator() {}
 
+/* Markers kept between events and density can not be added later, so when
+   they are kept all views with markers are drawn and only repainting of
+   hidden ones is deferred. Diagrams do not accumulate and 3d view has no
+   density, they are drawn lazily.
+*/
 void GeometryVisualizator::drawData()
 {
-  drawStrips(ProcessedData::getInstance().getActivedScintilators());
-  drawDiagram(ProcessedData::getInstance().getDiagramData());
-  drawLineBetweenActivedScins(ProcessedData::getInstance().getHits());
-  drawMarkers(ProcessedData::getInstance().getHits());
-  setMarker2d(ProcessedData::getInstance().getHits(),
-              ProcessedData::getInstance().getActivedScintilators());
+  ScopedTimer timer("drawData");
+  for (int i = 0; i < kNumberOfViews; i++) {
+    View view = static_cast< View >(i);
+    fViewOutdated[view] = true;
+    fCanvasOutdated[view] = true;
+    if (isAccumulating() && view != fActiveView && view != kDiagramView &&
+        (view != k3dView || fSaveMarkersBetweenEvents))
+      drawView(view);
+  }
+  updateActiveView();
+}
 
-  updateCanvas(fCanvas3d);
-  updateCanvas(fCanvas2d);
-  updateCanvas(fCanvasTopView);
-  updateCanvas(fCanvasDiagrams);
+void GeometryVisualizator::updateActiveView()
+{
+  updateView(fActiveView);
+}
+
+void GeometryVisualizator::updateView(View view)
+{
+  if (fViewOutdated[view])
+    drawView(view);
+  std::unique_ptr< TCanvas >& canvas = getViewCanvas(view);
+  if (fCanvasOutdated[view] && canvas) {
+    updateCanvas(canvas);
+    fCanvasOutdated[view] = false;
+  }
+}
+
+void GeometryVisualizator::drawView(View view)
+{
+  ProcessedData& data = ProcessedData::getInstance();
+  switch (view) {
+  case k3dView:
+    drawStrips3d(data.getActivedScintilators());
+    drawLineBetweenActivedScins(data.getHits());
+    break;
+  case kUnrolledView:
+    drawStrips2d(data.getActivedScintilators());
+    setMarker2d(data.getHits(), data.getActivedScintilators());
+    break;
+  case kTopView:
+    drawMarkers(data.getHits());
+    break;
+  case kDiagramView:
+    drawDiagram(data.getDiagramData());
+    break;
+  default:
+    return;
+  }
+  fViewOutdated[view] = false;
+}
+
+std::unique_ptr< TCanvas >& GeometryVisualizator::getViewCanvas(View view)
+{
+  switch (view) {
+  case k3dView:
+    return fCanvas3d;
+  case kUnrolledView:
+    return fCanvas2d;
+  case kTopView:
+    return fCanvasTopView;
+  default:
+    return fCanvasDiagrams;
+  }
 }
 
 void GeometryVisualizator::clearAllCanvases()
@@ -56,60 +117,231 @@ void GeometryVisualizator::clearAllCanvases()
   setAllStripsUnvisible();   // clear selected scintillators on 3d view
   setAllStripsUnvisible2d(); // clear selected scintillators on unrolled view
 
-  fCanvasDiagrams->Clear(); // clear diagrams
+  divideDiagramCanvas(0); // clear diagrams
+
+  f3dViewPrimitives.release();       // clear lines and markers on 3d view
+  fTopViewPrimitives.release();      // clear lines and markers on 2d view
+  fUnRolledViewPrimitives.release(); // clear markers on unrolled view
+  f3dAccumulated.clear();
+  fTopAccumulated.clear();
+  fUnRolledAccumulated.clear();
+  if (fTopViewDensity)
+    fTopViewDensity->Reset();
+  if (fUnRolledViewDensity)
+    fUnRolledViewDensity->Reset();
+}
 
-  for (TPolyLine3D* line : fLineOn3dView) { // clear lines and markers on 3d view
-    fCanvas3d->GetListOfPrimitives()->Remove(line);
-    delete line;
-  }
-  fLineOn3dView.clear();
-  for (TPolyMarker3D* marker : fMarkerOn3dView) {
-    fCanvas3d->GetListOfPrimitives()->Remove(marker);
-    delete marker;
-  }
-  fMarkerOn3dView.clear();
+void GeometryVisualizator::changeMarkersState()
+{
+  fSaveMarkersBetweenEvents = !fSaveMarkersBetweenEvents;
+  f3dAccumulated.clear();
+  fTopAccumulated.clear();
+  fUnRolledAccumulated.clear();
+}
 
-  for (TPolyLine* line : fLineOnTopView) { // clear lines and markers on 2d view
-    fCanvasTopView->GetListOfPrimitives()->Remove(line);
-    delete line;
+/* Hits of following events fill histograms drawn on top and unrolled views
+   instead of markers, painting them does not depend on number of events.
+   Histograms cover ranges of the canvases, so density can be shown only
+   after showGeometry.
+*/
+void GeometryVisualizator::changeDensityState()
+{
+  if (!fCanvasTopView || !fCanvas2d)
+    return;
+  fShowDensity = !fShowDensity;
+  if (!fTopViewDensity) {
+    fTopViewDensity = createDensityHistogram("topViewDensity",
+                      fCanvasTopView.get(), 120);
+    fUnRolledViewDensity = createDensityHistogram("unrolledViewDensity",
+                           fCanvas2d.get(), 300);
   }
-  fLineOnTopView.clear();
-  for (TPolyMarker* marker : fMarkerOnTopView) {
-    fCanvasTopView->GetListOfPrimitives()->Remove(marker);
-    delete marker;
+  fTopViewDensity->Reset();
+  fUnRolledViewDensity->Reset();
+  if (fShowDensity) {
+    drawDensityBelowFrame(fCanvasTopView.get(), fTopViewDensity.get(),
+                          fTopViewPrimitives);
+    drawDensityBelowFrame(fCanvas2d.get(), fUnRolledViewDensity.get(),
+                          fUnRolledViewPrimitives);
+  } else {
+    fCanvasTopView->GetListOfPrimitives()->Remove(fTopViewDensity.get());
+    fCanvas2d->GetListOfPrimitives()->Remove(fUnRolledViewDensity.get());
   }
-  fMarkerOnTopView.clear();
+}
 
-  for (TMarker* marker : fUnRolledViewMarker) { // clear markers on unrolled view
-    fCanvas2d->GetListOfPrimitives()->Remove(marker);
-    delete marker;
-  }
-  fUnRolledViewMarker.clear();
+/* Pads paint primitives in order of the list, the frame already drawn on the
+   pad is moved after the histogram to keep current event visible.
+*/
+void GeometryVisualizator::drawDensityBelowFrame(TCanvas* canvas,
+    TH2F* density, FramePrimitives& frame)
+{
+  canvas->cd();
+  density->Draw("COL SAME");
+  if (canvas->GetListOfPrimitives()->Remove(&frame))
+    canvas->GetListOfPrimitives()->Add(&frame);
+}
+
+std::unique_ptr< TH2F > GeometryVisualizator::createDensityHistogram(
+  const char* name, TCanvas* canvas, int bins) const
+{
+  std::unique_ptr< TH2F > histogram(
+    new TH2F(name, "", bins, canvas->GetX1(), canvas->GetX2(), bins,
+             canvas->GetY1(), canvas->GetY2()));
+  histogram->SetDirectory(nullptr);
+  histogram->SetStats(kFALSE);
+  return histogram;
+}
+
+/* Cell size is in cm for 3d and top views, markers on the unrolled view are
+   only limited by capacity.
+*/
+void GeometryVisualizator::setAccumulationLimits(size_t capacity,
+    double cellSize)
+{
+  f3dAccumulated.setLimits(capacity, cellSize);
+  fTopAccumulated.setLimits(capacity, cellSize);
+  fUnRolledAccumulated.setLimits(capacity, 0.);
+}
+
+void GeometryVisualizator::setAccumulatedPoints(TPolyMarker* marker,
+    const PointAccumulator& accumulated)
+{
+  const std::vector< PointAccumulator::Point >& points =
+    accumulated.getPoints();
+  marker->SetPolyMarker(points.size());
+  for (unsigned int i = 0; i < points.size(); i++)
+    marker->SetPoint(i, points[i].x, points[i].y);
+}
+
+void GeometryVisualizator::setAccumulatedPoints(TPolyMarker3D* marker,
+    const PointAccumulator& accumulated)
+{
+  const std::vector< PointAccumulator::Point >& points =
+    accumulated.getPoints();
+  marker->SetPolyMarker(points.size(), static_cast< Float_t* >(nullptr),
+                        marker->GetMarkerStyle());
+  for (unsigned int i = 0; i < points.size(); i++)
+    marker->SetPoint(i, points[i].x, points[i].y, points[i].z);
 }
 
 void GeometryVisualizator::updateCanvas(std::unique_ptr< TCanvas >& canvas)
 {
+  ScopedTimer timer("updateCanvas");
   canvas->Draw();
   canvas->Update();
   canvas->Modified();
 }
 
+/* Strips on the unrolled and 3d views are coloured with current palette,
+   from the lowest colour for the least hits to the highest for the maximum.
+   Strips without hits keep their default colours, so dead strips stand out.
+   Colours are reset by drawing next event, which then resets all strips.
+*/
+void GeometryVisualizator::drawOccupancy(const StripOccupancy& occupancy)
+{
+  ScopedTimer timer("drawOccupancy");
+  unsigned long long maximum = occupancy.getMaximum();
+  for (unsigned int i = 0; i < fUnRolledViewScintillators.size(); i++) {
+    for (unsigned int j = 0; j < fUnRolledViewScintillators[i].size(); j++) {
+      unsigned long long count = occupancy.get(i + 1, j + 1);
+      fUnRolledViewScintillators[i][j]->SetFillColor(
+        count > 0 ? getOccupancyColor(count, maximum) : kBlack);
+    }
+  }
+
+  assert(fGeoManager);
+  TGeoNode* topNode = fGeoManager->GetTopNode();
+  assert(topNode);
+  for (int i = 0; i < topNode->GetNdaughters(); i++) {
+    TGeoNode* nodeLayer = topNode->GetDaughter(i);
+    assert(nodeLayer);
+    for (int j = 0; j < nodeLayer->GetNdaughters(); j++) {
+      unsigned long long count = occupancy.get(i + 1, j + 1);
+      nodeLayer->GetDaughter(j)->GetVolume()->SetLineColor(
+        count > 0 ? getOccupancyColor(count, maximum) : getLayerColor(i));
+    }
+  }
+  fAllStripsColored = true;
+  fAllStripsColored2d = true;
+
+  updateCanvas(fCanvas3d);
+  updateCanvas(fCanvas2d);
+}
+
+int GeometryVisualizator::getOccupancyColor(unsigned long long count,
+    unsigned long long maximum) const
+{
+  int numberOfColors = gStyle->GetNumberOfColors();
+  if (maximum == 0 || numberOfColors <= 0)
+    return kRed;
+  int index = static_cast< int >((numberOfColors - 1) *
+                                 (static_cast< double >(count) / maximum));
+  return gStyle->GetColorPalette(index);
+}
+
+// layer is counted from 0
+int GeometryVisualizator::getLayerColor(size_t layer) const
+{
+  return layersColors[layer % kNumberOfLayerColors];
+}
+
+/* Canvases not embedded in the GUI, used in batch mode (gROOT->SetBatch)
+   to render views offscreen. Has to be called before showGeometry.
+*/
+void GeometryVisualizator::createBatchCanvases(unsigned int width,
+    unsigned int height)
+{
+  fCanvas3d = std::unique_ptr< TCanvas >(
+                new TCanvas("3dViewCanvas", "3d view", width, height));
+  fCanvas2d = std::unique_ptr< TCanvas >(
+                new TCanvas("2dViewCanvas", "Unrolled view", width, height));
+  fCanvasTopView = std::unique_ptr< TCanvas >(
+                     new TCanvas("canvasTopView", "Front view", width, height));
+  fCanvasDiagrams = std::unique_ptr< TCanvas >(
+                      new TCanvas("diagramCanvas", "Diagram view", width, height));
+}
+
+// each view is saved as <filePrefix>_<view>.<format>, e.g. event_12_3d.png
+void GeometryVisualizator::saveCanvases(
+  const std::string& filePrefix, const std::vector< std::string >& formats)
+{
+  for (int i = 0; i < kNumberOfViews; i++) // hidden views are outdated
+    updateView(static_cast< View >(i));
+  const std::pair< TCanvas*, const char* > views[] = {
+    {fCanvas3d.get(), "3d"},
+    {fCanvas2d.get(), "unrolled"},
+    {fCanvasTopView.get(), "top"},
+    {fCanvasDiagrams.get(), "diagram"}
+  };
+  for (const auto& view : views) {
+    if (!view.first)
+      continue;
+    for (const std::string& format : formats) {
+      std::string fileName = filePrefix + "_" + view.second + "." + format;
+      view.first->SaveAs(fileName.c_str());
+    }
+  }
+}
+
 void GeometryVisualizator::showGeometry()
 {
-  assert(fRootCanvas3d);
-  assert(fRootCanvas2d);
-  assert(fRootCanvasTopView);
-  assert(fRootCanvasDiagrams);
-  if (!fCanvas3d)
+  if (!fCanvas3d) {
+    assert(fRootCanvas3d);
     fCanvas3d = std::unique_ptr< TCanvas >(fRootCanvas3d->GetCanvas());
-  if (!fCanvas2d)
+  }
+  if (!fCanvas2d) {
+    assert(fRootCanvas2d);
     fCanvas2d = std::unique_ptr< TCanvas >(fRootCanvas2d->GetCanvas());
-  if (!fCanvasTopView)
+  }
+  if (!fCanvasTopView) {
+    assert(fRootCanvasTopView);
     fCanvasTopView =
       std::unique_ptr< TCanvas >(fRootCanvasTopView->GetCanvas());
-  if (!fCanvasDiagrams)
+  }
+  if (!fCanvasDiagrams) {
+    assert(fRootCanvasDiagrams);
     fCanvasDiagrams =
       std::unique_ptr< TCanvas >(fRootCanvasDiagrams->GetCanvas());
+  }
 
   draw2dGeometry();
   draw2dGeometry2();
@@ -117,7 +349,10 @@ void GeometryVisualizator::showGeometry()
   fCanvas3d->cd();
   assert(fGeoManager);
   Int_t irep;
-  fGeoManager->GetTopVolume()->Draw("ogl");
+  /* OpenGL viewer needs a display, so in batch mode the 3d view is always
+     drawn by the pad painter of ROOT (wireframe); images of the 3d view
+     are saved from it. */
+  fGeoManager->GetTopVolume()->Draw(gROOT->IsBatch() ? "" : "ogl");
   assert(gPad);
   TView* view = gPad->GetView();
   assert(view);
@@ -195,6 +430,8 @@ void GeometryVisualizator::setAllStripsUnvisible2d()
       fUnRolledViewScintillators[i][j]->SetFillColor(1);
     }
   }
+  fHighlightedStrips2d.clear();
+  fAllStripsColored2d = false;
   fCanvas2d->Modified();
   fCanvas2d->Update();
 }
@@ -202,85 +439,121 @@ void GeometryVisualizator::setAllStripsUnvisible2d()
 void GeometryVisualizator::setMarker2d(const HitPositions& pos,
                                        const ScintillatorsInLayers& selection)
 {
+  ScopedTimer timer("setMarker2d");
   fCanvas2d->cd();
 
-  if (!fSaveMarkersAndLinesBetweenEvents) {
-    for (TMarker* marker : fUnRolledViewMarker) {
-      fCanvas2d->GetListOfPrimitives()->Remove(marker);
-      delete marker;
-    }
-    fUnRolledViewMarker.clear();
-  }
+  fUnRolledViewPrimitives.release();
+  fUnRolledViewPrimitives.drawOn(fCanvas2d.get());
+  TPolyMarker* marker = fUnRolledViewPrimitives.create< TPolyMarker >();
+  marker->SetMarkerStyle(3);
+  marker->SetMarkerColor(kRed);
+  marker->SetMarkerSize(3);
 
   static const double kCenterOfScintillator = fScinLenghtWithoutScale / 2;
   unsigned int i = 0;
-  for (auto iter = selection.begin(); iter != selection.end(); ++iter) {
-    unsigned int layer = iter->first - 1; // table start form 0, layers from 1
-    const std::vector< size_t >& strips = iter->second;
-    for (auto stripIter = strips.begin(); stripIter != strips.end();
-         ++stripIter) {
-      unsigned int strip = *stripIter - 1;
-      if (layer < fUnRolledViewScintillators.size() &&
-          strip < fUnRolledViewScintillators[layer].size()) {
-        if (i == pos.size())
-          return;
-        double drawedScintillatorLength =
-          fUnRolledViewScintillators[layer][strip]->GetX2() -
-          fUnRolledViewScintillators[layer][strip]->GetX1();
-        double drawedScintillatorCenter = drawedScintillatorLength / 2;
-        double z = pos[i].Z() < kCenterOfScintillator &&
-                   pos[i].Z() > -kCenterOfScintillator
-                   ? pos[i].Z()
-                   : pos[i].Z() < kCenterOfScintillator
-                   ? -kCenterOfScintillator
-                   : kCenterOfScintillator;
-        double hittedXPos =
-          (drawedScintillatorCenter * z) / kCenterOfScintillator;
-        double centerX = fUnRolledViewScintillators[layer][strip]->GetX1() +
-                         ((fUnRolledViewScintillators[layer][strip]->GetX2() -
-                           fUnRolledViewScintillators[layer][strip]->GetX1()) /
-                          2);
-        double centerY = fUnRolledViewScintillators[layer][strip]->GetY1() +
-                         ((fUnRolledViewScintillators[layer][strip]->GetY2() -
-                           fUnRolledViewScintillators[layer][strip]->GetY1()) /
-                          2);
-        TMarker* marker = new TMarker(centerX + hittedXPos, centerY, 3);
-        marker->SetMarkerColor(kRed);
-        marker->SetMarkerSize(3);
-        marker->Draw();
-        fUnRolledViewMarker.push_back(marker);
-        i++;
-      }
+  for (const auto& actived : selection) {
+    unsigned int layer = actived.layer - 1; // table start form 0, layers from 1
+    unsigned int strip = actived.slot - 1;
+    if (layer < fUnRolledViewScintillators.size() &&
+        strip < fUnRolledViewScintillators[layer].size()) {
+      if (i == pos.size())
+        break;
+      double drawedScintillatorLength =
+        fUnRolledViewScintillators[layer][strip]->GetX2() -
+        fUnRolledViewScintillators[layer][strip]->GetX1();
+      double drawedScintillatorCenter = drawedScintillatorLength / 2;
+      double z = pos[i].Z() < kCenterOfScintillator &&
+                 pos[i].Z() > -kCenterOfScintillator
+                 ? pos[i].Z()
+                 : pos[i].Z() < kCenterOfScintillator
+                 ? -kCenterOfScintillator
+                 : kCenterOfScintillator;
+      double hittedXPos =
+        (drawedScintillatorCenter * z) / kCenterOfScintillator;
+      double centerX = fUnRolledViewScintillators[layer][strip]->GetX1() +
+                       ((fUnRolledViewScintillators[layer][strip]->GetX2() -
+                         fUnRolledViewScintillators[layer][strip]->GetX1()) /
+                        2);
+      double centerY = fUnRolledViewScintillators[layer][strip]->GetY1() +
+                       ((fUnRolledViewScintillators[layer][strip]->GetY2() -
+                         fUnRolledViewScintillators[layer][strip]->GetY1()) /
+                        2);
+      if (fShowDensity)
+        fUnRolledViewDensity->Fill(centerX + hittedXPos, centerY);
+      else if (fSaveMarkersBetweenEvents)
+        fUnRolledAccumulated.add(centerX + hittedXPos, centerY);
+      else
+        marker->SetNextPoint(centerX + hittedXPos, centerY);
+      i++;
     }
   }
+  if (fShowDensity)
+    marker->SetPolyMarker(0);
+  else if (fSaveMarkersBetweenEvents)
+    setAccumulatedPoints(marker, fUnRolledAccumulated);
 }
 
 void GeometryVisualizator::setVisibility2d(
   const ScintillatorsInLayers& selection)
 {
   fCanvas2d->cd();
-  for (auto iter = selection.begin(); iter != selection.end(); ++iter) {
-    unsigned int layer = iter->first - 1; // table start form 0, layers from 1
-    const std::vector< size_t >& strips = iter->second;
-    for (auto stripIter = strips.begin(); stripIter != strips.end();
-         ++stripIter) {
-      unsigned int strip = *stripIter - 1;
-      if (layer < fUnRolledViewScintillators.size() &&
-          strip < fUnRolledViewScintillators[layer].size()) {
-        fUnRolledViewScintillators[layer][strip]->SetFillColor(kRed);
-      }
+  for (const auto& actived : selection) {
+    unsigned int layer = actived.layer - 1; // table start form 0, layers from 1
+    unsigned int strip = actived.slot - 1;
+    if (layer < fUnRolledViewScintillators.size() &&
+        strip < fUnRolledViewScintillators[layer].size()) {
+      fUnRolledViewScintillators[layer][strip]->SetFillColor(kRed);
+      fHighlightedStrips2d.push_back(
+        std::make_pair(actived.layer, actived.slot));
     }
   }
 }
 
-void GeometryVisualizator::drawStrips(const ScintillatorsInLayers& selection)
+/* Only strips highlighted for previous event are reset, so drawing strips
+   depends on number of actived strips, not on size of the detector.
+*/
+void GeometryVisualizator::drawStrips3d(const ScintillatorsInLayers& selection)
 {
-  setAllStripsUnvisible();
-  setAllStripsUnvisible2d();
-  if (selection.empty())
-    return;
-  setVisibility(selection);
-  setVisibility2d(selection);
+  ScopedTimer timer("drawStrips3d");
+  if (fAllStripsColored)
+    setAllStripsUnvisible();
+  else
+    resetHighlightedStrips();
+  if (!selection.empty())
+    setVisibility(selection);
+}
+
+void GeometryVisualizator::drawStrips2d(const ScintillatorsInLayers& selection)
+{
+  ScopedTimer timer("drawStrips2d");
+  if (fAllStripsColored2d)
+    setAllStripsUnvisible2d();
+  else
+    resetHighlightedStrips2d();
+  if (!selection.empty())
+    setVisibility2d(selection);
+}
+
+void GeometryVisualizator::resetHighlightedStrips()
+{
+  assert(fGeoManager);
+  TGeoNode* topNode = fGeoManager->GetTopNode();
+  assert(topNode);
+  // strips were checked when added in setVisibility
+  for (const auto& strip : fHighlightedStrips) {
+    TGeoNode* nodeLayer = topNode->GetDaughter(strip.first - 1);
+    nodeLayer->GetDaughter(strip.second - 1)->GetVolume()->SetLineColor(
+      getLayerColor(strip.first - 1));
+  }
+  fHighlightedStrips.clear();
+}
+
+void GeometryVisualizator::resetHighlightedStrips2d()
+{
+  for (const auto& strip : fHighlightedStrips2d)
+    fUnRolledViewScintillators[strip.first - 1][strip.second - 1]->SetFillColor(
+      kBlack);
+  fHighlightedStrips2d.clear();
 }
 
 void GeometryVisualizator::setVisibility(const ScintillatorsInLayers& selection)
@@ -290,83 +563,70 @@ void GeometryVisualizator::setVisibility(const ScintillatorsInLayers& selection)
   assert(topNode);
   TGeoNode* nodeLayer = 0;
   TGeoNode* nodeStrip = 0;
-  unsigned int layer = JPetGeomMapping::kBadLayerNumber;
-  unsigned int strip = JPetGeomMapping::kBadSlotNumber;
-  for (auto iter = selection.begin(); iter != selection.end(); ++iter) {
-    layer = iter->first;
-    if (layer == JPetGeomMapping::kBadLayerNumber) {
-      std::cout << "/* Bad layer number in setVisibility, returning...*/"
+  for (const auto& actived : selection) {
+    // strips with bad layer or slot number are not added to selection
+    if (static_cast<Int_t>(actived.layer) > topNode->GetNdaughters()) {
+      std::cout << "/* Bad layer number in setVisibility, skipping...*/"
                 << "\n";
-      return;
+      continue;
     }
-    const std::vector< size_t >& strips = iter->second;
-    nodeLayer = topNode->GetDaughter(layer - 1);
+    nodeLayer = topNode->GetDaughter(actived.layer - 1);
     assert(nodeLayer);
-
-    for (auto stripIter = strips.begin(); stripIter != strips.end();
-         ++stripIter) {
-      strip = *stripIter;
-      if (strip == JPetGeomMapping::kBadSlotNumber) {
-        std::cout << "/* Bad strip number in setVisibility, returning...*/"
-                  << "\n";
-        return;
-      }
-      nodeStrip = nodeLayer->GetDaughter(strip - 1);
-      assert(nodeStrip);
-      nodeStrip->GetVolume()->SetLineColor(kRed);
+    if (static_cast<Int_t>(actived.slot) > nodeLayer->GetNdaughters()) {
+      std::cout << "/* Bad strip number in setVisibility, skipping...*/"
+                << "\n";
+      continue;
     }
+    nodeStrip = nodeLayer->GetDaughter(actived.slot - 1);
+    assert(nodeStrip);
+    nodeStrip->GetVolume()->SetLineColor(kRed);
+    fHighlightedStrips.push_back(std::make_pair(actived.layer, actived.slot));
   }
 }
 
 void GeometryVisualizator::drawMarkers(const HitPositions& pos)
 {
+  ScopedTimer timer("drawMarkers");
   fCanvasTopView->cd();
-  if (!fSaveMarkersAndLinesBetweenEvents) {
-    for (TPolyLine* line : fLineOnTopView) {
-      fCanvasTopView->GetListOfPrimitives()->Remove(line);
-      delete line;
-    }
-    fLineOnTopView.clear();
-    for (TPolyMarker* marker : fMarkerOnTopView) {
-      fCanvasTopView->GetListOfPrimitives()->Remove(marker);
-      delete marker;
-    }
-    fMarkerOnTopView.clear();
-  }
-  fLineOnTopView.push_back(new TPolyLine());
-  fMarkerOnTopView.push_back(new TPolyMarker());
+  fTopViewPrimitives.release();
+  fTopViewPrimitives.drawOn(fCanvasTopView.get());
+  TPolyLine* line = fTopViewPrimitives.create< TPolyLine >();
+  TPolyMarker* marker = fTopViewPrimitives.create< TPolyMarker >();
+  line->SetLineWidth(2);
+  line->SetLineColor(kRed);
+  line->SetLineStyle(4);
+  marker->SetMarkerSize(2);
+  marker->SetMarkerColor(kGreen);
+  marker->SetMarkerStyle(2);
   for (unsigned int i = 0; i < pos.size(); i++) {
-    fLineOnTopView.back()->SetLineWidth(2);
-    fLineOnTopView.back()->SetLineColor(kRed);
-    fLineOnTopView.back()->SetLineStyle(4);
-    fLineOnTopView.back()->SetNextPoint(pos[i].X(), pos[i].Y());
-
-    fMarkerOnTopView.back()->SetMarkerSize(2);
-    fMarkerOnTopView.back()->SetMarkerColor(kGreen);
-    fMarkerOnTopView.back()->SetMarkerStyle(2);
-    fMarkerOnTopView.back()->SetNextPoint(pos[i].X(), pos[i].Y());
+    line->SetNextPoint(pos[i].X(), pos[i].Y());
+    if (fShowDensity)
+      fTopViewDensity->Fill(pos[i].X(), pos[i].Y());
+    else if (fSaveMarkersBetweenEvents)
+      fTopAccumulated.add(pos[i].X(), pos[i].Y());
+    else
+      marker->SetNextPoint(pos[i].X(), pos[i].Y());
   }
-  fLineOnTopView.back()->Draw();
-  fMarkerOnTopView.back()->Draw();
+  if (fShowDensity)
+    marker->SetPolyMarker(0);
+  else if (fSaveMarkersBetweenEvents)
+    setAccumulatedPoints(marker, fTopAccumulated);
 }
 
 void GeometryVisualizator::drawLineBetweenActivedScins(const HitPositions& pos)
 {
+  ScopedTimer timer("drawLineBetweenActivedScins");
   fCanvas3d->cd();
-  if (!fSaveMarkersAndLinesBetweenEvents) {
-    for (TPolyLine3D* line : fLineOn3dView) {
-      fCanvas3d->GetListOfPrimitives()->Remove(line);
-      delete line;
-    }
-    fLineOn3dView.clear();
-    for (TPolyMarker3D* marker : fMarkerOn3dView) {
-      fCanvas3d->GetListOfPrimitives()->Remove(marker);
-      delete marker;
-    }
-    fMarkerOn3dView.clear();
-  }
-  fLineOn3dView.push_back(new TPolyLine3D());
-  fMarkerOn3dView.push_back(new TPolyMarker3D());
+  f3dViewPrimitives.release();
+  f3dViewPrimitives.drawOn(fCanvas3d.get());
+  TPolyLine3D* line = f3dViewPrimitives.create< TPolyLine3D >();
+  TPolyMarker3D* marker = f3dViewPrimitives.create< TPolyMarker3D >();
+  line->SetLineWidth(2);
+  line->SetLineColor(kRed);
+  line->SetLineStyle(4);
+  marker->SetMarkerSize(2);
+  marker->SetMarkerColor(kGreen);
+  marker->SetMarkerStyle(2);
   static const double kScintillatorLenghtFromCenter = fScinLenghtWithoutScale;
   for (unsigned int i = 0; i < pos.size(); i++) {
     double x = pos[i].X();
@@ -377,18 +637,14 @@ void GeometryVisualizator::drawLineBetweenActivedScins(const HitPositions& pos)
                : pos[i].Z() < kScintillatorLenghtFromCenter
                ? -kScintillatorLenghtFromCenter
                : kScintillatorLenghtFromCenter;
-    fLineOn3dView.back()->SetLineWidth(2);
-    fLineOn3dView.back()->SetLineColor(kRed);
-    fLineOn3dView.back()->SetLineStyle(4);
-    fLineOn3dView.back()->SetNextPoint(x, y, z);
-
-    fMarkerOn3dView.back()->SetMarkerSize(2);
-    fMarkerOn3dView.back()->SetMarkerColor(kGreen);
-    fMarkerOn3dView.back()->SetMarkerStyle(2);
-    fMarkerOn3dView.back()->SetNextPoint(x, y, z);
+    line->SetNextPoint(x, y, z);
+    if (fSaveMarkersBetweenEvents)
+      f3dAccumulated.add(x, y, z);
+    else
+      marker->SetNextPoint(x, y, z);
   }
-  fLineOn3dView.back()->Draw();
-  fMarkerOn3dView.back()->Draw();
+  if (fSaveMarkersBetweenEvents)
+    setAccumulatedPoints(marker, f3dAccumulated);
 }
 
 void GeometryVisualizator::draw2dGeometry2()
@@ -439,98 +695,150 @@ void GeometryVisualizator::setAllStripsUnvisible()
     int fNumberOfStrips = node->GetNdaughters();
     for (int j = 0; j < fNumberOfStrips; j++) {
       TGeoNode* stripNode = node->GetDaughter(j);
-      stripNode->GetVolume()->SetLineColor(layersColors[i]);
+      stripNode->GetVolume()->SetLineColor(getLayerColor(i));
     }
   }
+  fHighlightedStrips.clear();
+  fAllStripsColored = false;
 }
 
-void GeometryVisualizator::drawDiagram(const DiagramDataMapVector& diagramData)
+void GeometryVisualizator::drawDiagram(const SignalDiagrams& diagramData)
 {
-  if (fRootCanvasDiagrams == 0) {
-    WARNING("Canvas not set");
-    return;
-  }
-  if (fCanvasDiagrams == 0)
+  ScopedTimer timer("drawDiagram");
+  if (fCanvasDiagrams == 0) {
+    if (fRootCanvasDiagrams == 0) {
+      WARNING("Canvas not set");
+      return;
+    }
     fCanvasDiagrams =
       std::unique_ptr< TCanvas >(fRootCanvasDiagrams->GetCanvas());
+  }
   int vectorSize = diagramData.size();
+  if (vectorSize != fLastDiagramVectorSize)
+    divideDiagramCanvas(vectorSize);
+
+  for (int j = 0; j < vectorSize; j++)
+    updateDiagramPad(j, diagramData[j]);
+}
+
+/* Pads are recreated only when number of signals changes, objects drawn
+   on them are kept and drawn again on new pads.
+*/
+void GeometryVisualizator::divideDiagramCanvas(int numberOfPads)
+{
   fCanvasDiagrams->cd();
-  fCanvasDiagrams->Clear();
-  if (vectorSize != fLastDiagramVectorSize) {
-    fCanvasDiagrams->Clear();
-    fCanvasDiagrams->DivideSquare(vectorSize);
-  }
+  fCanvasDiagrams->Clear(); // deletes pads, does not delete objects of pads
+  if (numberOfPads > 0)
+    fCanvasDiagrams->DivideSquare(numberOfPads);
+  for (DiagramPad& pad : fDiagramPads)
+    pad.drawn = 0;
+  if (fDiagramPads.size() < static_cast< size_t >(numberOfPads))
+    fDiagramPads.resize(numberOfPads);
+  fLastDiagramVectorSize = numberOfPads;
+}
 
-  for (int j = 0; j < vectorSize; j++) {
-    fCanvasDiagrams->cd(j + 1);
-    int n = diagramData[j].size();
-    if (n == 0)
-      return;
-    std::vector< float > leadingX;
-    std::vector< float > leadingY;
-    std::vector< float > trailingX;
-    std::vector< float > trailingY;
-    const float kPsToNs = 0.001;
-    float minXValue = std::numeric_limits<float>::max();
-    float maxXValue = - std::numeric_limits<float>::max(); // min() is returning min positive value
-    for (auto it = diagramData[j].begin(); it != diagramData[j].end(); it++) {
-      if (std::get< 3 >(*it) == JPetSigCh::Leading) {
-        float x = static_cast<float>(std::get<2>(*it)) * kPsToNs;
-        if (x < minXValue)
-          minXValue = x;
-        leadingX.push_back(x);
-        leadingY.push_back(changeSignalNumber(std::get< 0 >(*it)));
-      } else {
-        float x = static_cast<float>(std::get<2>(*it)) * kPsToNs;
-        if (x > maxXValue)
-          maxXValue = x;
-        trailingX.push_back(x);
-        trailingY.push_back(changeSignalNumber(std::get< 0 >(*it)));
-      }
+void GeometryVisualizator::updateDiagramPad(unsigned int padNumber,
+    const SignalDiagram& diagram)
+{
+  TVirtualPad* canvasPad = fCanvasDiagrams->cd(padNumber + 1);
+  if (!canvasPad)
+    return;
+  DiagramPad& pad = fDiagramPads[padNumber];
+  float leadingX[SignalDiagram::kMaxPoints];
+  float leadingY[SignalDiagram::kMaxPoints];
+  float trailingX[SignalDiagram::kMaxPoints];
+  float trailingY[SignalDiagram::kMaxPoints];
+  int nLeading = 0;
+  int nTrailing = 0;
+  const float kPsToNs = 0.001;
+  float minXValue = std::numeric_limits<float>::max();
+  float maxXValue = - std::numeric_limits<float>::max(); // min() is returning min positive value
+  for (const DiagramPoint& point : diagram) {
+    float x = point.time * kPsToNs;
+    minXValue = std::min(minXValue, x);
+    maxXValue = std::max(maxXValue, x);
+    if (point.edge == JPetSigCh::Leading) {
+      leadingX[nLeading] = x;
+      leadingY[nLeading++] = changeSignalNumber(point.thresholdNumber);
+    } else {
+      trailingX[nTrailing] = x;
+      trailingY[nTrailing++] = changeSignalNumber(point.thresholdNumber);
     }
-    TMultiGraph* mg = new TMultiGraph();
-
-    std::string title = "layer ";
-    title.append(std::to_string(std::get< 5 >(*diagramData[j].begin())));
-    title.append(" slot ");
-    title.append(std::to_string(std::get< 6 >(*diagramData[j].begin())));
-    if (std::get< 4 >(*diagramData[j].begin()) == JPetPM::SideA)
-      title.append(" Side A");
-    else
-      title.append(" Side B");
-    mg->SetTitle(title.c_str());
+  }
+  if (minXValue >= maxXValue) { // single point or the same times
+    minXValue -= 0.5;
+    maxXValue += 0.5;
+  }
 
-    if (leadingX.size() > 0) {
-      TGraph* gr =
-        new TGraph(leadingX.size(), leadingX.data(), leadingY.data());
-      mg->Add(gr);
+  unsigned int drawn = 0;
+  if (!diagram.empty())
+    drawn |= DiagramPad::kFrame;
+  if (nLeading > 0)
+    drawn |= DiagramPad::kLeading;
+  if (nTrailing > 0)
+    drawn |= DiagramPad::kTrailing;
+
+  if (!pad.frame) {
+    std::string name = "diagramFrame" + std::to_string(padNumber);
+    pad.frame = std::unique_ptr< TH1F >(new TH1F(name.c_str(), "", 1, 0, 1));
+    pad.frame->SetDirectory(nullptr);
+    pad.frame->SetStats(kFALSE);
+    pad.frame->SetMinimum(0);
+    pad.frame->SetMaximum(5);
+    pad.frame->GetYaxis()->SetLabelOffset(999);
+    pad.frame->GetYaxis()->SetTickLength(0);
+    pad.frame->GetXaxis()->SetNdivisions(504, kFALSE);
+    pad.frame->GetXaxis()->SetTitle("Time (ns)");
+    pad.frame->GetYaxis()->SetTitle("Threshold Number");
+    pad.leading = std::unique_ptr< TGraph >(new TGraph());
+    pad.trailing = std::unique_ptr< TGraph >(new TGraph());
+    pad.trailing->SetMarkerColor(kRed);
+    for (auto& line : pad.thresholds) {
+      line = std::unique_ptr< TLine >(new TLine());
+      line->SetLineColor(kRed);
     }
+  }
 
-    if (trailingX.size() > 0) {
-      TGraph* gr2 =
-        new TGraph(trailingX.size(), trailingX.data(), trailingY.data());
-      gr2->SetMarkerColor(kRed);
-
-      mg->Add(gr2);
-    }
+  std::string title = "layer ";
+  title.append(std::to_string(diagram.layer));
+  title.append(" slot ");
+  title.append(std::to_string(diagram.slot));
+  if (diagram.side == JPetPM::SideA)
+    title.append(" Side A");
+  else
+    title.append(" Side B");
+  pad.frame->SetTitle(title.c_str());
+  pad.frame->GetXaxis()->SetLimits(minXValue, maxXValue);
+
+  pad.leading->Set(nLeading);
+  for (int i = 0; i < nLeading; i++)
+    pad.leading->SetPoint(i, leadingX[i], leadingY[i]);
+  pad.trailing->Set(nTrailing);
+  for (int i = 0; i < nTrailing; i++)
+    pad.trailing->SetPoint(i, trailingX[i], trailingY[i]);
+  for (int k = 0; k < SignalDiagram::kMaxThresholds; k++) {
+    pad.thresholds[k]->SetX1(minXValue);
+    pad.thresholds[k]->SetY1(k + 1);
+    pad.thresholds[k]->SetX2(maxXValue);
+    pad.thresholds[k]->SetY2(k + 1);
+  }
 
-    mg->Draw("AP*");
-    mg->GetYaxis()->SetLabelOffset(999);
-    mg->GetYaxis()->SetTickLength(0);
-    mg->GetYaxis()->SetRangeUser(0, 5);
-    mg->GetXaxis()->SetLimits(minXValue, maxXValue);
-    mg->GetXaxis()->SetNdivisions(504, kFALSE);
-    mg->GetXaxis()->SetTitle("Time (ns)");
-    mg->GetYaxis()->SetTitle("Threshold Number");
-
-    int kNumberOfThresholds = 4;
-    for (int k = 0; k < kNumberOfThresholds; k++) {
-      TLine* line = new TLine(mg->GetXaxis()->GetXmin(), k + 1,
-                              mg->GetXaxis()->GetXmax(), k + 1);
-      line->SetLineColor(kRed);
-      line->Draw();
+  // objects are added to the pad again only if set of drawn objects changed,
+  // graphs without points are not drawn
+  if (drawn != pad.drawn) {
+    canvasPad->Clear();
+    if (drawn & DiagramPad::kFrame) {
+      pad.frame->Draw("AXIS");
+      if (drawn & DiagramPad::kLeading)
+        pad.leading->Draw("P*");
+      if (drawn & DiagramPad::kTrailing)
+        pad.trailing->Draw("P*");
+      for (auto& line : pad.thresholds)
+        line->Draw();
     }
+    pad.drawn = drawn;
   }
+  canvasPad->Modified();
 }
 
 float GeometryVisualizator::changeSignalNumber(int signalNumber)
@@ -598,11 +906,11 @@ void GeometryVisualizator::createGeometry(
     vol = new TGeoVolume(nameOfLayer, layer, medium);
     assert(vol);
     vol->SetVisibility(kTRUE);
-    currentFi = startFi[i];
+    currentFi = startFi[i % (sizeof(startFi) / sizeof(startFi[0]))];
 
     for (int j = 0; j < layerStats[i].first; j++) {
       TGeoVolume* scin = gGeoManager->MakeBox("scin", medium, 1.9, 0.7, scintillatorLenght / 2);
-      scin->SetLineColorAlpha(layersColors[i], 0.3);
+      scin->SetLineColorAlpha(getLayerColor(i), 0.3);
       TGeoTranslation trans(
         layerStats[i].second * std::cos(currentFi * (M_PI / 180)),
         layerStats[i].second * std::sin(currentFi * (M_PI / 180)), 0);
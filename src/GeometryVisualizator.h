@@ -27,6 +27,8 @@
 #include <TGeoVolume.h>
 #include <TGeoMatrix.h>
 #include <TGraph.h>
+#include <TH1F.h>
+#include <TH2F.h>
 #include <TLine.h>
 #include <TMarker.h>
 #include <TMultiGraph.h>
@@ -44,9 +46,13 @@
 #include <cassert>
 #include <map>
 #include <memory>
+#include <string>
 #include <vector>
 
 #include "DataProcessor.h"
+#include "FramePrimitives.h"
+#include "PointAccumulator.h"
+#include "OccupancyScanner.h"
 
 #include <TRootEmbeddedCanvas.h>
 
@@ -54,9 +60,22 @@ class TCanvas;
 
 namespace jpet_event_display
 {
+/* Views are drawn from the frame in ProcessedData. Only the active view
+   (visible tab) is drawn by drawData, hidden views are marked outdated and
+   drawn when they become active, see updateActiveView.
+*/
 class GeometryVisualizator
 {
 public:
+  // in order of tabs in the GUI
+  enum View {
+    k3dView,
+    kUnrolledView,
+    kTopView,
+    kDiagramView,
+    kNumberOfViews
+  };
+
   GeometryVisualizator(
     const int numberOfLayers, const int scintillatorLenght,
     const std::vector< std::pair< int, double > >& layerStats);
@@ -66,6 +85,30 @@ public:
   void drawData();
   void clearAllCanvases();
 
+  inline void setActiveView(View view)
+  {
+    fActiveView = view;
+  }
+  inline View getActiveView() const
+  {
+    return fActiveView;
+  }
+  void updateActiveView();
+  inline bool isViewOutdated(View view) const
+  {
+    return fViewOutdated[view];
+  }
+  inline size_t getNumberOfHighlightedStrips() const
+  {
+    return fHighlightedStrips.size();
+  }
+
+  void drawOccupancy(const StripOccupancy& occupancy);
+
+  void createBatchCanvases(unsigned int width, unsigned int height);
+  void saveCanvases(const std::string& filePrefix,
+                    const std::vector< std::string >& formats);
+
   inline std::unique_ptr< TRootEmbeddedCanvas >& getCanvas3d()
   {
     return fRootCanvas3d;
@@ -83,10 +126,18 @@ public:
     return fRootCanvasDiagrams;
   }
 
-  inline void changeMarkersState()
+  void changeMarkersState();
+  void changeDensityState();
+  inline bool isShowingDensity() const
+  {
+    return fShowDensity;
+  }
+  // markers or density of all shown events are kept
+  inline bool isAccumulating() const
   {
-    fSaveMarkersAndLinesBetweenEvents = !fSaveMarkersAndLinesBetweenEvents;
+    return fSaveMarkersBetweenEvents || fShowDensity;
   }
+  void setAccumulationLimits(size_t capacity, double cellSize);
 
 private:
 #ifndef __CINT__
@@ -95,12 +146,18 @@ private:
                  const std::vector< std::pair< int, double > >& layerStats);
 
   void updateCanvas(std::unique_ptr< TCanvas >& canvas);
+  std::unique_ptr< TCanvas >& getViewCanvas(View view);
+  void updateView(View view);
+  void drawView(View view);
 
   void draw2dGeometry();
-  void drawStrips(const ScintillatorsInLayers& selection);
+  void drawStrips3d(const ScintillatorsInLayers& selection);
+  void drawStrips2d(const ScintillatorsInLayers& selection);
   void drawPads();
   void setAllStripsUnvisible();
   void setAllStripsUnvisible2d();
+  void resetHighlightedStrips();
+  void resetHighlightedStrips2d();
   void setVisibility(const ScintillatorsInLayers& selection);
   void setVisibility2d(const ScintillatorsInLayers& selection);
   void setMarker2d(const HitPositions& pos,
@@ -108,11 +165,25 @@ private:
 
   void drawLineBetweenActivedScins(const HitPositions& pos);
   void drawMarkers(const HitPositions& pos);
-  void drawDiagram(const DiagramDataMapVector& diagramData);
+  std::unique_ptr< TH2F > createDensityHistogram(const char* name,
+      TCanvas* canvas, int bins) const;
+  void drawDensityBelowFrame(TCanvas* canvas, TH2F* density,
+                             FramePrimitives& frame);
+  void setAccumulatedPoints(TPolyMarker* marker,
+                            const PointAccumulator& accumulated);
+  void setAccumulatedPoints(TPolyMarker3D* marker,
+                            const PointAccumulator& accumulated);
+  void drawDiagram(const SignalDiagrams& diagramData);
+  void divideDiagramCanvas(int numberOfPads);
+  void updateDiagramPad(unsigned int padNumber, const SignalDiagram& diagram);
   float changeSignalNumber(int signalNumber);
 
   void draw2dGeometry2();
 
+  int getOccupancyColor(unsigned long long count,
+                        unsigned long long maximum) const;
+  int getLayerColor(size_t layer) const;
+
   enum ColorTable {
     kBlack = 1,
     kRed = 2,
@@ -136,17 +207,50 @@ private:
 
   int fLastDiagramVectorSize = 0;
 
-  bool fSaveMarkersAndLinesBetweenEvents = false;
+  /* Objects of one pad of the diagram view, created once and updated in
+     place for every event.
+  */
+  struct DiagramPad {
+    enum Drawn { kFrame = 1, kLeading = 2, kTrailing = 4 };
+
+    std::unique_ptr< TH1F > frame;
+    std::unique_ptr< TGraph > leading;
+    std::unique_ptr< TGraph > trailing;
+    std::unique_ptr< TLine > thresholds[SignalDiagram::kMaxThresholds];
+    unsigned int drawn = 0; // Drawn flags of objects in the pad
+  };
+  std::vector< DiagramPad > fDiagramPads;
+
+  bool fSaveMarkersBetweenEvents = false;
+  bool fShowDensity = false;
+
+  View fActiveView = k3dView;
+  bool fViewOutdated[kNumberOfViews] = {};   // not drawn for current frame
+  bool fCanvasOutdated[kNumberOfViews] = {}; // not repainted since change
 
-  std::vector< TPolyLine3D* > fLineOn3dView;
-  std::vector< TPolyMarker3D* > fMarkerOn3dView;
+  // strips coloured by setVisibility(2d), (layer, slot) counted from 1, only
+  // these are reset on next event unless all colours were changed
+  std::vector< std::pair< size_t, size_t > > fHighlightedStrips;
+  std::vector< std::pair< size_t, size_t > > fHighlightedStrips2d;
+  bool fAllStripsColored = false;
+  bool fAllStripsColored2d = false;
 
-  std::vector< TPolyLine* > fLineOnTopView;
-  std::vector< TPolyMarker* > fMarkerOnTopView;
+  // lines and markers of shown events, released when next event is drawn
+  FramePrimitives f3dViewPrimitives;
+  FramePrimitives fTopViewPrimitives;
+  FramePrimitives fUnRolledViewPrimitives;
+  // markers of previous events, drawn with one marker per view
+  PointAccumulator f3dAccumulated;
+  PointAccumulator fTopAccumulated;
+  PointAccumulator fUnRolledAccumulated;
+  // hits of all events since density is shown, instead of markers
+  std::unique_ptr< TH2F > fTopViewDensity;
+  std::unique_ptr< TH2F > fUnRolledViewDensity;
 
   std::vector< std::vector< TBox* > > fUnRolledViewScintillators;
-  std::vector< TMarker* > fUnRolledViewMarker;
-  ColorTable layersColors[3] {kGray1, kGray2, kGray3};
+  // repeated for detectors with more layers, see getLayerColor
+  static const size_t kNumberOfLayerColors = 3;
+  ColorTable layersColors[kNumberOfLayerColors] {kGray1, kGray2, kGray3};
 #endif
 };
 }
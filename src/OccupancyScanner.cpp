@@ -0,0 +1,184 @@
+/**
+ *  @copyright Copyright 2016 The J-PET Framework Authors. All rights reserved.
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may find a copy of the License in the LICENCE file.
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *  @file OccupancyScanner.cpp
+ */
+
+#include "./OccupancyScanner.h"
+#include <JPetLoggerInclude.h>
+#include <algorithm>
+#include <functional>
+
+namespace jpet_event_display
+{
+
+void StripOccupancy::setLayerSizes(const std::vector<size_t>& layerSizes)
+{
+  fCounts.resize(layerSizes.size());
+  for (size_t i = 0; i < layerSizes.size(); i++)
+    fCounts[i].assign(layerSizes[i], 0);
+}
+
+// strips outside of the geometry given in setLayerSizes extend the arrays
+void StripOccupancy::add(size_t layer, size_t slot, unsigned long long hits)
+{
+  if (layer == 0 || slot == 0)
+    return;
+  if (fCounts.size() < layer)
+    fCounts.resize(layer);
+  std::vector<unsigned long long>& slots = fCounts[layer - 1];
+  if (slots.size() < slot)
+    slots.resize(slot, 0);
+  slots[slot - 1] += hits;
+}
+
+void StripOccupancy::add(const ScintillatorsInLayers& selection)
+{
+  for (const auto& strip : selection)
+    add(strip.layer, strip.slot, strip.hits);
+}
+
+void StripOccupancy::merge(const StripOccupancy& other)
+{
+  for (size_t i = 0; i < other.fCounts.size(); i++) {
+    for (size_t j = 0; j < other.fCounts[i].size(); j++) {
+      if (other.fCounts[i][j] != 0)
+        add(i + 1, j + 1, other.fCounts[i][j]);
+    }
+  }
+}
+
+// counts are zeroed, layer sizes are kept
+void StripOccupancy::reset()
+{
+  for (auto& slots : fCounts)
+    std::fill(slots.begin(), slots.end(), 0);
+}
+
+unsigned long long StripOccupancy::get(size_t layer, size_t slot) const
+{
+  if (layer == 0 || slot == 0 || layer > fCounts.size() ||
+      slot > fCounts[layer - 1].size())
+    return 0;
+  return fCounts[layer - 1][slot - 1];
+}
+
+unsigned long long StripOccupancy::getMaximum() const
+{
+  unsigned long long maximum = 0;
+  for (const auto& slots : fCounts) {
+    for (unsigned long long count : slots)
+      maximum = std::max(maximum, count);
+  }
+  return maximum;
+}
+
+unsigned long long StripOccupancy::getTotal() const
+{
+  unsigned long long total = 0;
+  for (const auto& slots : fCounts) {
+    for (unsigned long long count : slots)
+      total += count;
+  }
+  return total;
+}
+
+OccupancyScanner::OccupancyScanner(
+  std::shared_ptr<JPetGeomMapping> mapper,
+  std::shared_ptr<const StripPosTable> stripPositions,
+  const std::string& fileName, const EventIndex& index,
+  unsigned int numberOfThreads)
+  : fMapper(mapper), fStripPositions(stripPositions), fFileName(fileName),
+    fIndex(index), fLayerSizes(mapper->getLayersSizes())
+{
+  long long numberOfEvents = fIndex.getNumberOfEvents();
+  if (numberOfThreads == 0)
+    numberOfThreads = 1;
+  if (numberOfThreads > numberOfEvents)
+    numberOfThreads = numberOfEvents > 0 ? numberOfEvents : 1;
+  long long chunk = (numberOfEvents + numberOfThreads - 1) / numberOfThreads;
+  fRunningThreads = numberOfThreads;
+  for (unsigned int i = 0; i < numberOfThreads; i++) {
+    fAccumulators.emplace_back(new Accumulator());
+    fAccumulators.back()->occupancy.setLayerSizes(fLayerSizes);
+  }
+  for (unsigned int i = 0; i < numberOfThreads; i++) {
+    long long first = i * chunk;
+    long long last = std::min(first + chunk, numberOfEvents) - 1;
+    fThreads.emplace_back(&OccupancyScanner::scan, this,
+                          std::ref(*fAccumulators[i]), first, last);
+  }
+}
+
+OccupancyScanner::~OccupancyScanner()
+{
+  stop();
+}
+
+void OccupancyScanner::stop()
+{
+  fStop = true;
+  for (std::thread& thread : fThreads) {
+    if (thread.joinable())
+      thread.join();
+  }
+}
+
+StripOccupancy OccupancyScanner::getOccupancy()
+{
+  StripOccupancy result;
+  result.setLayerSizes(fLayerSizes);
+  for (const auto& accumulator : fAccumulators) {
+    std::lock_guard<std::mutex> lock(accumulator->mutex);
+    result.merge(accumulator->occupancy);
+  }
+  return result;
+}
+
+void OccupancyScanner::flush(Accumulator& accumulator, StripOccupancy& local,
+                             long long& numberOfEvents)
+{
+  {
+    std::lock_guard<std::mutex> lock(accumulator.mutex);
+    accumulator.occupancy.merge(local);
+  }
+  local.reset();
+  fProcessedEvents += numberOfEvents;
+  numberOfEvents = 0;
+}
+
+void OccupancyScanner::scan(Accumulator& accumulator, long long firstEvent,
+                            long long lastEvent)
+{
+  DataProcessor decoder(fMapper, fStripPositions);
+  decoder.setRequiredData(kStripData); // signals of hits are not read
+  if (firstEvent <= lastEvent && !decoder.openFile(fFileName.c_str(), fIndex)) {
+    ERROR("Could not open file for occupancy scan: " + fFileName);
+    fRunningThreads--;
+    return;
+  }
+  StripOccupancy local;
+  local.setLayerSizes(fLayerSizes);
+  DisplayFrame frame; // reused, so decoding does not allocate per event
+  long long numberOfEvents = 0;
+  for (long long i = firstEvent; i <= lastEvent && !fStop; i++) {
+    if (decoder.decodeEvent(i, frame))
+      local.add(frame.getActivedScintilators());
+    if (++numberOfEvents == kFlushInterval)
+      flush(accumulator, local, numberOfEvents);
+  }
+  flush(accumulator, local, numberOfEvents);
+  if (firstEvent <= lastEvent)
+    decoder.closeFile();
+  fRunningThreads--;
+}
+} // namespace jpet_event_display
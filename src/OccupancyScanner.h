@@ -0,0 +1,111 @@
+/**
+ *  @copyright Copyright 2016 The J-PET Framework Authors. All rights reserved.
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may find a copy of the License in the LICENCE file.
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *  @brief Counts hits in every strip over the whole file on worker threads.
+ */
+
+#ifndef OCCUPANCYSCANNER_H
+#define OCCUPANCYSCANNER_H
+
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "DataProcessor.h"
+
+namespace jpet_event_display
+{
+/* Number of hits per strip. Layers and slots are counted from 1, as in
+   ScintillatorsInLayers.
+*/
+class StripOccupancy
+{
+public:
+  void setLayerSizes(const std::vector<size_t>& layerSizes);
+  void add(size_t layer, size_t slot, unsigned long long hits);
+  void add(const ScintillatorsInLayers& selection);
+  void merge(const StripOccupancy& other);
+  void reset();
+
+  unsigned long long get(size_t layer, size_t slot) const;
+  unsigned long long getMaximum() const;
+  unsigned long long getTotal() const;
+
+private:
+  std::vector<std::vector<unsigned long long>> fCounts; // [layer - 1][slot - 1]
+};
+
+/* Events of the file are split into contiguous ranges, one per thread. Every
+   thread has its own DataProcessor (and reader) and accumulates counts
+   locally, merging them into its shared accumulator every kFlushInterval
+   events. getOccupancy reduces shared accumulators of all threads, so
+   partial result can be shown while the scan is running.
+*/
+class OccupancyScanner
+{
+public:
+  OccupancyScanner(std::shared_ptr<JPetGeomMapping> mapper,
+                   std::shared_ptr<const StripPosTable> stripPositions,
+                   const std::string& fileName, const EventIndex& index,
+                   unsigned int numberOfThreads);
+  ~OccupancyScanner();
+
+  void stop();
+  StripOccupancy getOccupancy();
+
+  inline bool isFinished() const
+  {
+    return fRunningThreads == 0;
+  }
+  inline long long getNumberOfProcessedEvents() const
+  {
+    return fProcessedEvents;
+  }
+  inline long long getNumberOfEvents() const
+  {
+    return fIndex.getNumberOfEvents();
+  }
+
+private:
+  OccupancyScanner(const OccupancyScanner&) = delete;
+  OccupancyScanner& operator=(const OccupancyScanner&) = delete;
+
+  struct Accumulator {
+    std::mutex mutex;
+    StripOccupancy occupancy;
+  };
+
+  void scan(Accumulator& accumulator, long long firstEvent,
+            long long lastEvent);
+  void flush(Accumulator& accumulator, StripOccupancy& local,
+             long long& numberOfEvents);
+
+  static const long long kFlushInterval = 1000;
+
+  std::shared_ptr<JPetGeomMapping> fMapper;
+  std::shared_ptr<const StripPosTable> fStripPositions;
+  std::string fFileName;
+  EventIndex fIndex;
+  std::vector<size_t> fLayerSizes;
+
+  std::atomic<bool> fStop {false};
+  std::atomic<unsigned int> fRunningThreads {0};
+  std::atomic<long long> fProcessedEvents {0};
+  std::vector<std::unique_ptr<Accumulator>> fAccumulators;
+  std::vector<std::thread> fThreads;
+};
+} // namespace jpet_event_display
+
+#endif /*  !OCCUPANCYSCANNER_H */
@@ -0,0 +1,58 @@
+/**
+ *  @copyright Copyright 2016 The J-PET Framework Authors. All rights reserved.
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may find a copy of the License in the LICENCE file.
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *  @file PlaybackClock.cpp
+ */
+
+#include "./PlaybackClock.h"
+
+namespace jpet_event_display
+{
+// skipped frames and measured rate are kept from previous playback
+void PlaybackClock::start(double eventsPerSecond, Clock::time_point now)
+{
+  if (eventsPerSecond > 0)
+    fEventsPerSecond = eventsPerSecond;
+  fStart = now;
+  fAdvanced = 0;
+  fWindowStart = now;
+  fFramesInWindow = 0;
+}
+
+unsigned long long PlaybackClock::advance(Clock::time_point now)
+{
+  std::chrono::duration<double> elapsed = now - fStart;
+  if (elapsed.count() < 0)
+    return 0;
+  unsigned long long due =
+    static_cast<unsigned long long>(elapsed.count() * fEventsPerSecond);
+  if (due <= fAdvanced)
+    return 0;
+  unsigned long long events = due - fAdvanced;
+  fAdvanced = due;
+  fSkipped += events - 1;
+  return events;
+}
+
+// returns true when measured rate was updated
+bool PlaybackClock::frameShown(Clock::time_point now)
+{
+  fFramesInWindow++;
+  std::chrono::duration<double> elapsed = now - fWindowStart;
+  if (elapsed.count() < 1.)
+    return false;
+  fFramesPerSecond = fFramesInWindow / elapsed.count();
+  fWindowStart = now;
+  fFramesInWindow = 0;
+  return true;
+}
+} // namespace jpet_event_display
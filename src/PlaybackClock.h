@@ -0,0 +1,62 @@
+/**
+ *  @copyright Copyright 2016 The J-PET Framework Authors. All rights reserved.
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may find a copy of the License in the LICENCE file.
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *  @brief Pacing of timer-driven playback of events.
+ */
+
+#ifndef PLAYBACKCLOCK_H
+#define PLAYBACKCLOCK_H
+
+#include <chrono>
+
+namespace jpet_event_display
+{
+/* Tells how many events should be advanced on each timer tick to keep the
+   target rate. When drawing takes longer than 1 / rate, more than one event
+   is due and all but the last are skipped (counted as skipped frames).
+   Rate of actually shown frames is measured over about one second.
+*/
+class PlaybackClock
+{
+public:
+  typedef std::chrono::steady_clock Clock;
+
+  void start(double eventsPerSecond, Clock::time_point now = Clock::now());
+  unsigned long long advance(Clock::time_point now = Clock::now());
+  bool frameShown(Clock::time_point now = Clock::now());
+
+  inline double getEventsPerSecond() const
+  {
+    return fEventsPerSecond;
+  }
+  inline double getFramesPerSecond() const
+  {
+    return fFramesPerSecond;
+  }
+  inline unsigned long long getSkipped() const
+  {
+    return fSkipped;
+  }
+
+private:
+  double fEventsPerSecond = 1.;
+  Clock::time_point fStart;
+  unsigned long long fAdvanced = 0; // events advanced since start
+  unsigned long long fSkipped = 0;
+
+  Clock::time_point fWindowStart;
+  unsigned int fFramesInWindow = 0;
+  double fFramesPerSecond = 0.;
+};
+} // namespace jpet_event_display
+
+#endif /*  !PLAYBACKCLOCK_H */
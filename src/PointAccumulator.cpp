@@ -0,0 +1,76 @@
+/**
+ *  @copyright Copyright 2016 The J-PET Framework Authors. All rights reserved.
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may find a copy of the License in the LICENCE file.
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *  @file PointAccumulator.cpp
+ */
+
+#include "./PointAccumulator.h"
+#include <cmath>
+
+namespace jpet_event_display
+{
+PointAccumulator::PointAccumulator(size_t capacity, double cellSize)
+  : fCapacity(capacity), fCellSize(cellSize)
+{
+}
+
+void PointAccumulator::setLimits(size_t capacity, double cellSize)
+{
+  if (capacity == fCapacity && cellSize == fCellSize)
+    return;
+  fCapacity = capacity;
+  fCellSize = cellSize;
+  clear();
+}
+
+bool PointAccumulator::add(float x, float y, float z)
+{
+  if (fCapacity == 0)
+    return false;
+  Point point = {x, y, z};
+  if (fCellSize > 0.) {
+    unsigned int& count = fOccupiedCells[getCell(point)];
+    if (count > 0)
+      return false;
+    count++;
+  }
+  if (fPoints.size() < fCapacity) {
+    fPoints.push_back(point);
+    return true;
+  }
+  if (fCellSize > 0.) {
+    auto replaced = fOccupiedCells.find(getCell(fPoints[fNext]));
+    if (replaced != fOccupiedCells.end() && --replaced->second == 0)
+      fOccupiedCells.erase(replaced);
+  }
+  fPoints[fNext] = point;
+  fNext = (fNext + 1) % fCapacity;
+  return true;
+}
+
+void PointAccumulator::clear()
+{
+  fPoints.clear();
+  fNext = 0;
+  fOccupiedCells.clear();
+}
+
+// 21 bits for every coordinate of the cell, enough for any detector
+uint64_t PointAccumulator::getCell(const Point& point) const
+{
+  const uint64_t kMask = (1 << 21) - 1;
+  uint64_t x = static_cast<int64_t>(std::floor(point.x / fCellSize)) & kMask;
+  uint64_t y = static_cast<int64_t>(std::floor(point.y / fCellSize)) & kMask;
+  uint64_t z = static_cast<int64_t>(std::floor(point.z / fCellSize)) & kMask;
+  return (x << 42) | (y << 21) | z;
+}
+} // namespace jpet_event_display
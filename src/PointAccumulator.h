@@ -0,0 +1,78 @@
+/**
+ *  @copyright Copyright 2016 The J-PET Framework Authors. All rights reserved.
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may find a copy of the License in the LICENCE file.
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *  @brief Bounded cloud of points of many events, drawn as one marker.
+ */
+
+#ifndef POINTACCUMULATOR_H
+#define POINTACCUMULATOR_H
+
+#include <cstddef>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+namespace jpet_event_display
+{
+/* Points of consecutive events are kept in a ring buffer of given capacity,
+   when it is full the oldest point is replaced. With cell size > 0 a point
+   is not added if another kept point lies in the same cubic cell (grid
+   decimation), so dense regions do not fill the buffer. Order of points in
+   getPoints() is not the order of adding.
+*/
+class PointAccumulator
+{
+public:
+  struct Point {
+    float x;
+    float y;
+    float z;
+  };
+
+  static const size_t kDefaultCapacity = 100000;
+
+  explicit PointAccumulator(size_t capacity = kDefaultCapacity,
+                            double cellSize = 0.);
+
+  void setLimits(size_t capacity, double cellSize);
+  bool add(float x, float y, float z = 0.f);
+  void clear();
+
+  inline const std::vector<Point>& getPoints() const
+  {
+    return fPoints;
+  }
+  inline size_t size() const
+  {
+    return fPoints.size();
+  }
+  inline size_t getCapacity() const
+  {
+    return fCapacity;
+  }
+  inline double getCellSize() const
+  {
+    return fCellSize;
+  }
+
+private:
+  uint64_t getCell(const Point& point) const;
+
+  size_t fCapacity;
+  double fCellSize;
+  std::vector<Point> fPoints;
+  size_t fNext = 0; // replaced when buffer is full
+  std::unordered_map<uint64_t, unsigned int> fOccupiedCells;
+};
+} // namespace jpet_event_display
+
+#endif /*  !POINTACCUMULATOR_H */
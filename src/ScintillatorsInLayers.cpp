@@ -0,0 +1,78 @@
+/**
+ *  @copyright Copyright 2016 The J-PET Framework Authors. All rights reserved.
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may find a copy of the License in the LICENCE file.
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *  @file ScintillatorsInLayers.cpp
+ */
+
+#include "./ScintillatorsInLayers.h"
+#include <algorithm>
+
+namespace jpet_event_display
+{
+
+void ScintillatorsInLayers::add(size_t layer, size_t slot, unsigned int hits)
+{
+  if (layer == 0 || slot == 0)
+    return;
+  unsigned long long key = getKey(layer, slot);
+  auto it = std::lower_bound(fIndex.begin(), fIndex.end(), key,
+  [](const IndexEntry & entry, unsigned long long k) {
+    return entry.key < k;
+  });
+  if (it == fIndex.end() || it->key != key) {
+    fActived.push_back(Strip {layer, slot, 0});
+    unsigned int position = fActived.size() - 1;
+    it = fIndex.insert(it, IndexEntry {key, position});
+  }
+  fActived[it->position].hits += hits;
+}
+
+bool ScintillatorsInLayers::contains(size_t layer, size_t slot) const
+{
+  return find(getKey(layer, slot)) != fIndex.end();
+}
+
+unsigned int ScintillatorsInLayers::getNumberOfHits(size_t layer,
+    size_t slot) const
+{
+  auto it = find(getKey(layer, slot));
+  return it != fIndex.end() ? fActived[it->position].hits : 0;
+}
+
+void ScintillatorsInLayers::clear()
+{
+  fActived.clear();
+  fIndex.clear();
+}
+
+size_t ScintillatorsInLayers::getMemorySize() const
+{
+  return fActived.capacity() * sizeof(Strip) +
+         fIndex.capacity() * sizeof(IndexEntry);
+}
+
+unsigned long long ScintillatorsInLayers::getKey(size_t layer, size_t slot)
+{
+  return (static_cast<unsigned long long>(layer) << 32) |
+         static_cast<unsigned long long>(slot);
+}
+
+std::vector<ScintillatorsInLayers::IndexEntry>::const_iterator
+ScintillatorsInLayers::find(unsigned long long key) const
+{
+  auto it = std::lower_bound(fIndex.begin(), fIndex.end(), key,
+  [](const IndexEntry & entry, unsigned long long k) {
+    return entry.key < k;
+  });
+  return it != fIndex.end() && it->key == key ? it : fIndex.end();
+}
+} // namespace jpet_event_display
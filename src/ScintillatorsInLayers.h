@@ -0,0 +1,78 @@
+/**
+ *  @copyright Copyright 2016 The J-PET Framework Authors. All rights reserved.
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may find a copy of the License in the LICENCE file.
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *  @brief Set of actived scintillators with number of hits in each of them.
+ */
+
+#ifndef SCINTILLATORSINLAYERS_H
+#define SCINTILLATORSINLAYERS_H
+
+#include <cstddef>
+#include <vector>
+
+namespace jpet_event_display
+{
+/* Only actived strips are stored, so memory, copying and clearing depend on
+   the number of fired strips and not on the size of the detector. Strips are
+   kept in order of activation, a sorted index of (layer, slot) keys finds a
+   strip in O(log n). Layers and slots are counted from 1, as in
+   JPetGeomMapping.
+*/
+class ScintillatorsInLayers
+{
+public:
+  struct Strip {
+    size_t layer;
+    size_t slot;
+    unsigned int hits;
+  };
+  typedef std::vector<Strip>::const_iterator const_iterator;
+
+  void add(size_t layer, size_t slot, unsigned int hits = 1);
+  bool contains(size_t layer, size_t slot) const;
+  unsigned int getNumberOfHits(size_t layer, size_t slot) const;
+  void clear();
+
+  inline bool empty() const
+  {
+    return fActived.empty();
+  }
+  inline size_t size() const
+  {
+    return fActived.size();
+  }
+  inline const_iterator begin() const
+  {
+    return fActived.begin();
+  }
+  inline const_iterator end() const
+  {
+    return fActived.end();
+  }
+
+  size_t getMemorySize() const;
+
+private:
+  struct IndexEntry {
+    unsigned long long key;
+    unsigned int position; // in fActived
+  };
+
+  static unsigned long long getKey(size_t layer, size_t slot);
+  std::vector<IndexEntry>::const_iterator find(unsigned long long key) const;
+
+  std::vector<Strip> fActived;
+  std::vector<IndexEntry> fIndex; // sorted by key
+};
+} // namespace jpet_event_display
+
+#endif /*  !SCINTILLATORSINLAYERS_H */
@@ -0,0 +1,162 @@
+/**
+ *  @copyright Copyright 2016 The J-PET Framework Authors. All rights reserved.
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may find a copy of the License in the LICENCE file.
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *  @file StageTimer.cpp
+ */
+
+#include "./StageTimer.h"
+#include <JPetLoggerInclude.h>
+#include <fstream>
+#include <functional>
+#include <thread>
+
+namespace jpet_event_display
+{
+
+Profiler::Profiler()
+  : fAveragedThread(std::thread::id()), fOrigin(Clock::now()) {}
+
+void Profiler::setEnabled(bool enabled)
+{
+  if (enabled)
+    fAveragedThread = std::this_thread::get_id();
+  fEnabled = enabled;
+}
+
+void Profiler::setTracing(bool tracing)
+{
+  fTracing = tracing;
+}
+
+void Profiler::reset()
+{
+  std::lock_guard<std::mutex> lock(fMutex);
+  fStages.clear();
+  fTrace.clear();
+  fOrigin = Clock::now();
+}
+
+void Profiler::record(const char* stage, Clock::time_point start,
+                      Clock::time_point end)
+{
+  // other threads do not take the lock unless their intervals are traced
+  bool averaged = std::this_thread::get_id() == fAveragedThread.load();
+  bool traced = fTracing;
+  if (!averaged && !traced)
+    return;
+  double milliseconds =
+    std::chrono::duration<double, std::milli>(end - start).count();
+  std::lock_guard<std::mutex> lock(fMutex);
+  if (averaged) {
+    Stage& data = fStages[stage];
+    if (data.recent.size() < kWindowSize) {
+      data.recent.push_back(milliseconds);
+    } else {
+      data.sum -= data.recent[data.next];
+      data.recent[data.next] = milliseconds;
+      data.next = (data.next + 1) % kWindowSize;
+    }
+    data.sum += milliseconds;
+    data.total += milliseconds;
+    data.count++;
+  }
+  if (traced && fTrace.size() < kMaxTraceSize) {
+    fTrace.push_back({stage,
+                      std::chrono::duration_cast<std::chrono::nanoseconds>(
+                        start - fOrigin).count(),
+                      std::chrono::duration_cast<std::chrono::nanoseconds>(
+                        end - start).count(),
+                      std::hash<std::thread::id>()(std::this_thread::get_id())
+                     });
+  }
+}
+
+// average of the last kWindowSize durations of the stage
+bool Profiler::getAverage(const std::string& stage, double& milliseconds)
+{
+  std::lock_guard<std::mutex> lock(fMutex);
+  auto data = fStages.find(stage);
+  if (data == fStages.end() || data->second.recent.empty())
+    return false;
+  milliseconds = data->second.sum / data->second.recent.size();
+  return true;
+}
+
+unsigned long long Profiler::getCount(const std::string& stage)
+{
+  std::lock_guard<std::mutex> lock(fMutex);
+  auto data = fStages.find(stage);
+  return data == fStages.end() ? 0 : data->second.count;
+}
+
+double Profiler::getTotal(const std::string& stage)
+{
+  std::lock_guard<std::mutex> lock(fMutex);
+  auto data = fStages.find(stage);
+  return data == fStages.end() ? 0. : data->second.total;
+}
+
+// one line per stage: number of measurements, mean and total time
+void Profiler::printSummary(std::ostream& out)
+{
+  std::lock_guard<std::mutex> lock(fMutex);
+  for (const auto& stage : fStages) {
+    const Stage& data = stage.second;
+    out << stage.first << ": " << data.count << " x "
+        << data.total / data.count << " ms, total " << data.total << " ms\n";
+  }
+}
+
+// format is chosen by extension, .csv gives CSV, anything else Chrome trace
+bool Profiler::dumpTrace(const std::string& fileName)
+{
+  std::ofstream out(fileName.c_str());
+  if (!out) {
+    ERROR("Could not write trace file: " + fileName);
+    return false;
+  }
+  const std::string csv = ".csv";
+  std::lock_guard<std::mutex> lock(fMutex);
+  if (fTrace.size() == kMaxTraceSize)
+    WARNING("Trace is truncated to " + std::to_string(kMaxTraceSize) +
+            " intervals");
+  if (fileName.size() > csv.size() &&
+      fileName.compare(fileName.size() - csv.size(), csv.size(), csv) == 0)
+    return writeCsv(out);
+  return writeChromeTrace(out);
+}
+
+bool Profiler::writeChromeTrace(std::ostream& out) const
+{
+  out << "{\"traceEvents\": [\n";
+  for (size_t i = 0; i < fTrace.size(); i++) {
+    const Interval& interval = fTrace[i];
+    out << "  {\"name\": \"" << interval.stage
+        << "\", \"cat\": \"stage\", \"ph\": \"X\", \"ts\": "
+        << interval.start / 1000. << ", \"dur\": " << interval.duration / 1000.
+        << ", \"pid\": 0, \"tid\": " << interval.thread % 100000 << "}"
+        << (i + 1 < fTrace.size() ? "," : "") << "\n";
+  }
+  out << "]}\n";
+  return static_cast<bool>(out);
+}
+
+bool Profiler::writeCsv(std::ostream& out) const
+{
+  out << "stage,thread,start_us,duration_us\n";
+  for (const Interval& interval : fTrace) {
+    out << interval.stage << "," << interval.thread % 100000 << ","
+        << interval.start / 1000. << "," << interval.duration / 1000. << "\n";
+  }
+  return static_cast<bool>(out);
+}
+} // namespace jpet_event_display
@@ -0,0 +1,126 @@
+/**
+ *  @copyright Copyright 2016 The J-PET Framework Authors. All rights reserved.
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may find a copy of the License in the LICENCE file.
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *  @brief Timing of pipeline stages: reading, extraction and drawing.
+ */
+
+#ifndef STAGETIMER_H
+#define STAGETIMER_H
+
+#include <atomic>
+#include <chrono>
+#include <iosfwd>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace jpet_event_display
+{
+/* Collects durations of stages measured by ScopedTimer. Averages are kept
+   only for the thread which enabled profiling (the GUI or batch thread),
+   so background decoding does not mix with timing of shown events; for
+   every stage a rolling average of the last kWindowSize durations and the
+   mean of all of them are kept. With tracing on, every measured interval of
+   every thread is stored with its thread and can be dumped as Chrome trace
+   (.json, for chrome://tracing) or CSV file.
+*/
+class Profiler
+{
+public:
+  typedef std::chrono::steady_clock Clock;
+
+  static Profiler& getInstance()
+  {
+    static Profiler fSingleton;
+    return fSingleton;
+  }
+
+  inline bool isEnabled() const
+  {
+    return fEnabled.load(std::memory_order_relaxed);
+  }
+  void setEnabled(bool enabled);
+  void setTracing(bool tracing);
+  void reset();
+
+  void record(const char* stage, Clock::time_point start,
+              Clock::time_point end);
+  bool getAverage(const std::string& stage, double& milliseconds);
+  unsigned long long getCount(const std::string& stage);
+  double getTotal(const std::string& stage); // in ms
+  void printSummary(std::ostream& out);
+  bool dumpTrace(const std::string& fileName);
+
+  static const size_t kWindowSize = 64;
+  static const size_t kMaxTraceSize = 1 << 22; // intervals kept for trace
+
+private:
+  Profiler();
+  Profiler(const Profiler&) = delete;
+  Profiler& operator=(const Profiler&) = delete;
+
+  struct Stage {
+    std::vector<double> recent; // ring of the last durations, in ms
+    size_t next = 0;
+    double sum = 0.;
+    double total = 0.; // sum of all durations
+    unsigned long long count = 0;
+  };
+  struct Interval {
+    const char* stage;
+    long long start; // in ns since fOrigin
+    long long duration;
+    size_t thread;
+  };
+
+  bool writeChromeTrace(std::ostream& out) const;
+  bool writeCsv(std::ostream& out) const;
+
+  std::atomic<bool> fEnabled {false};
+  std::atomic<bool> fTracing {false};
+  std::atomic<std::thread::id> fAveragedThread;
+  std::mutex fMutex; // guards all members below
+  std::map<std::string, Stage> fStages;
+  std::vector<Interval> fTrace;
+  Clock::time_point fOrigin;
+};
+
+/* Measures the scope it is declared in. When profiling is disabled only
+   one relaxed atomic load is done, clock is not read.
+*/
+class ScopedTimer
+{
+public:
+  explicit ScopedTimer(const char* stage)
+    : fStage(Profiler::getInstance().isEnabled() ? stage : nullptr)
+  {
+    if (fStage)
+      fStart = Profiler::Clock::now();
+  }
+  ~ScopedTimer()
+  {
+    if (fStage)
+      Profiler::getInstance().record(fStage, fStart, Profiler::Clock::now());
+  }
+
+private:
+  ScopedTimer(const ScopedTimer&) = delete;
+  ScopedTimer& operator=(const ScopedTimer&) = delete;
+
+  const char* fStage; // string literal
+  Profiler::Clock::time_point fStart;
+};
+} // namespace jpet_event_display
+
+#endif /*  !STAGETIMER_H */
@@ -0,0 +1,50 @@
+/**
+ *  @copyright Copyright 2016 The J-PET Framework Authors. All rights reserved.
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may find a copy of the License in the LICENCE file.
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *  @file StripPosTable.cpp
+ */
+
+#include "./StripPosTable.h"
+
+namespace jpet_event_display
+{
+
+const StripPos StripPosTable::kBadStripPos = {
+  JPetGeomMapping::kBadLayerNumber, JPetGeomMapping::kBadSlotNumber
+};
+
+StripPosTable::StripPosTable(const JPetGeomMapping& mapper,
+                             const JPetParamBank& bank)
+{
+  for (const auto& slot : bank.getBarrelSlots()) {
+    if (slot.second && !slot.second->isNullObject())
+      insert(fByBarrelSlot, slot.first, mapper.getStripPos(*slot.second));
+  }
+  for (const auto& pm : bank.getPMs()) {
+    if (!pm.second || pm.second->isNullObject())
+      continue;
+    const JPetBarrelSlot& slot = pm.second->getBarrelSlot();
+    if (!slot.isNullObject())
+      insert(fByPM, pm.first, mapper.getStripPos(slot));
+  }
+}
+
+void StripPosTable::insert(std::vector<StripPos>& table, int id,
+                           const StripPos& pos)
+{
+  if (id < 0)
+    return;
+  if (static_cast<size_t>(id) >= table.size())
+    table.resize(id + 1, kBadStripPos);
+  table[id] = pos;
+}
+} // namespace jpet_event_display
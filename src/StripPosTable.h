@@ -0,0 +1,70 @@
+/**
+ *  @copyright Copyright 2016 The J-PET Framework Authors. All rights reserved.
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may find a copy of the License in the LICENCE file.
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *  @brief Precomputed strip positions of barrel slots and photomultipliers.
+ */
+
+#ifndef STRIPPOSTABLE_H
+#define STRIPPOSTABLE_H
+
+#include <vector>
+
+#ifndef __CINT__
+#ifndef __ROOTCLING__
+#include <JPetGeomMapping/JPetGeomMapping.h>
+#include <JPetParamBank/JPetParamBank.h>
+#endif
+#endif
+
+namespace jpet_event_display
+{
+/* Strip positions indexed directly by barrel slot id and PM id, so mapping
+   a channel does not need to walk PM -> scintillator -> barrel slot and ask
+   JPetGeomMapping each time. Unknown ids are mapped to kBadStripPos.
+*/
+class StripPosTable
+{
+public:
+  StripPosTable(const JPetGeomMapping& mapper, const JPetParamBank& bank);
+
+  inline const StripPos& getStripPos(const JPetBarrelSlot& slot) const
+  {
+    return lookup(fByBarrelSlot, slot.getID());
+  }
+  inline const StripPos& getStripPos(const JPetPM& pm) const
+  {
+    return lookup(fByPM, pm.getID());
+  }
+  static inline bool isValid(const StripPos& pos)
+  {
+    return pos.layer != JPetGeomMapping::kBadLayerNumber &&
+           pos.slot != JPetGeomMapping::kBadSlotNumber;
+  }
+
+private:
+  static inline const StripPos& lookup(const std::vector<StripPos>& table,
+                                       int id)
+  {
+    return id >= 0 && static_cast<size_t>(id) < table.size() ? table[id]
+           : kBadStripPos;
+  }
+  static void insert(std::vector<StripPos>& table, int id,
+                     const StripPos& pos);
+
+  static const StripPos kBadStripPos;
+
+  std::vector<StripPos> fByBarrelSlot;
+  std::vector<StripPos> fByPM;
+};
+} // namespace jpet_event_display
+
+#endif /*  !STRIPPOSTABLE_H */
@@ -0,0 +1,119 @@
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MODULE BatchRendererTest
+#include <boost/test/unit_test.hpp>
+
+#include "../src/BatchRenderer.h"
+#include "../src/EventIndex.h"
+#include "./TestHelpers.h"
+#include <JPetParamGetterAscii/JPetParamGetterAscii.h>
+#include <JPetParamManager/JPetParamManager.h>
+#include <JPetSigCh/JPetSigCh.h>
+#include <JPetTimeWindow/JPetTimeWindow.h>
+#include <JPetWriter/JPetWriter.h>
+#include <TROOT.h>
+#include <deque>
+
+using namespace jpet_event_display;
+
+namespace
+{
+// a signal channel in each time window, on PMs one after another
+void writeSigChData(const std::string& fileName, const JPetParamBank& bank,
+                    int numberOfTimeWindows)
+{
+  JPetWriter writer(fileName.c_str());
+  writer.writeObject(&bank, "ParamBank");
+  auto pm = bank.getPMs().begin();
+  for (int i = 0; i < numberOfTimeWindows; i++, pm++) {
+    JPetTimeWindow timeWindow("JPetSigCh");
+    JPetSigCh sigCh;
+    sigCh.setPM(*pm->second);
+    sigCh.setThresholdNumber(1);
+    sigCh.setThreshold(80.f);
+    sigCh.setType(JPetSigCh::Leading);
+    sigCh.setValue(1000. * i);
+    timeWindow.add<JPetSigCh>(sigCh);
+    writer.write(timeWindow);
+  }
+  writer.closeFile();
+}
+} // namespace
+
+BOOST_AUTO_TEST_SUITE(FirstSuite)
+
+BOOST_AUTO_TEST_CASE( ParseEventRange )
+{
+  long long first = 0, last = 0;
+  BOOST_REQUIRE(BatchRenderer::parseEventRange("100-5000", first, last));
+  BOOST_REQUIRE_EQUAL(first, 100);
+  BOOST_REQUIRE_EQUAL(last, 5000);
+  BOOST_REQUIRE(BatchRenderer::parseEventRange("7", first, last));
+  BOOST_REQUIRE_EQUAL(first, 7);
+  BOOST_REQUIRE_EQUAL(last, 7);
+}
+
+BOOST_AUTO_TEST_CASE( ParseBadEventRange )
+{
+  long long first = 0, last = 0;
+  BOOST_REQUIRE(!BatchRenderer::parseEventRange("", first, last));
+  BOOST_REQUIRE(!BatchRenderer::parseEventRange("-5", first, last));
+  BOOST_REQUIRE(!BatchRenderer::parseEventRange("10-5", first, last));
+  BOOST_REQUIRE(!BatchRenderer::parseEventRange("10-", first, last));
+  BOOST_REQUIRE(!BatchRenderer::parseEventRange("10:20", first, last));
+  BOOST_REQUIRE(!BatchRenderer::parseEventRange("10-20x", first, last));
+}
+
+BOOST_AUTO_TEST_CASE( ParseFormats )
+{
+  std::vector<std::string> formats = BatchRenderer::parseFormats("png,,svg");
+  BOOST_REQUIRE_EQUAL(formats.size(), 2u);
+  BOOST_REQUIRE_EQUAL(formats[0], "png");
+  BOOST_REQUIRE_EQUAL(formats[1], "svg");
+  BOOST_REQUIRE(BatchRenderer::parseFormats("").empty());
+}
+
+BOOST_AUTO_TEST_CASE( RenderedEventsAreSaved )
+{
+  gROOT->SetBatch(kTRUE);
+  TemporaryFile geometry("BatchRendererTest_geometry.json",
+                         makeBarrelGeometry({4, 8}));
+  JPetParamManager manager(new JPetParamGetterAscii(geometry.getName()));
+  manager.fillParameterBank(0);
+  const JPetParamBank& bank = manager.getParamBank();
+  TemporaryFile data("BatchRendererTest_data.root");
+  data.addDerivedFile(EventIndex::getIndexFileName(data.getName()));
+  writeSigChData(data.getName(), bank, 3);
+
+  auto mapper = std::make_shared<JPetGeomMapping>(bank);
+  std::vector<size_t> layersSize = mapper->getLayersSizes();
+  std::vector<std::pair<int, double>> layerStats;
+  for (size_t i = 0; i + 1 < layersSize.size(); i++)
+    layerStats.push_back(
+      std::make_pair(layersSize[i], mapper->getRadiusOfLayer(i + 1)));
+  BatchOptions options;
+  options.dataFileName = data.getName();
+  options.outputDirectory = "BatchRendererTest_output";
+  options.canvasWidth = 200;
+  options.canvasHeight = 200;
+  // directory is removed last, after the files in it
+  TemporaryFile outputDirectory(options.outputDirectory);
+  std::deque<TemporaryFile> images;
+  const char* views[] = {"3d", "unrolled", "top", "diagram"};
+  for (int event = 1; event <= 2; event++) {
+    for (const char* view : views)
+      images.emplace_back(options.outputDirectory + "/event_0000000" +
+                          std::to_string(event) + "_" + view + ".png");
+  }
+  options.firstEvent = 1;
+  options.lastEvent = 2;
+  BatchRenderer renderer(mapper, bank, layerStats.size(), 50, layerStats,
+                         options);
+  BOOST_REQUIRE_EQUAL(renderer.run(), 0);
+  for (const TemporaryFile& image : images)
+    BOOST_REQUIRE_MESSAGE(std::ifstream(image.getName().c_str()).good(),
+                          image.getName() + " was not written");
+  BOOST_REQUIRE(!std::ifstream((options.outputDirectory +
+                                "/event_00000000_3d.png").c_str()));
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -6,11 +6,106 @@
 
 using namespace jpet_event_display;
 
+namespace
+{
+JPetSigCh makeSigCh(int threshold, JPetSigCh::EdgeType edge, float time)
+{
+  JPetSigCh sigCh;
+  sigCh.setThresholdNumber(threshold);
+  sigCh.setThreshold(80.f * threshold);
+  sigCh.setType(edge);
+  sigCh.setValue(time);
+  return sigCh;
+}
+
+// leading edges at 1000 + 100 * threshold, trailing ones 5000 later
+void makePoints(int numberOfThresholds, std::vector<JPetSigCh>& leading,
+                std::vector<JPetSigCh>& trailing)
+{
+  for (int i = 1; i <= numberOfThresholds; i++) {
+    leading.push_back(makeSigCh(i, JPetSigCh::Leading, 1000.f + 100.f * i));
+    trailing.push_back(makeSigCh(i, JPetSigCh::Trailing, 6000.f + 100.f * i));
+  }
+}
+} // namespace
+
 BOOST_AUTO_TEST_SUITE(FirstSuite)
 
-BOOST_AUTO_TEST_CASE( DataProcessorTest )
-{ 
-  BOOST_REQUIRE(1==0); 
+BOOST_AUTO_TEST_CASE( FileTypeIsResolvedFromClassName )
+{
+  BOOST_REQUIRE_EQUAL(DataProcessor::getFileType("JPetSigCh"), FileTypes::fSigCh);
+  BOOST_REQUIRE_EQUAL(DataProcessor::getFileType("JPetRawSignal"),
+                      FileTypes::fRawSignal);
+  BOOST_REQUIRE_EQUAL(DataProcessor::getFileType("JPetHit"), FileTypes::fHit);
+  BOOST_REQUIRE_EQUAL(DataProcessor::getFileType("JPetEvent"), FileTypes::fEvent);
+  BOOST_REQUIRE_EQUAL(DataProcessor::getFileType("JPetBarrelSlot"),
+                      FileTypes::fNone);
+  BOOST_REQUIRE_EQUAL(DataProcessor::getFileType(""), FileTypes::fNone);
+}
+
+BOOST_AUTO_TEST_CASE( SignalsAreSkippedWithoutDiagrams )
+{
+  const FileTypes typesWithSignals[] = {FileTypes::fHit, FileTypes::fEvent};
+  for (FileTypes type : typesWithSignals) {
+    std::vector<std::string> skipped =
+      DataProcessor::getSkippedMembers(type, kStripData | kHitData);
+    BOOST_REQUIRE_EQUAL(skipped.size(), 2u);
+    BOOST_REQUIRE_EQUAL(skipped[0], "fSignalA");
+    BOOST_REQUIRE_EQUAL(skipped[1], "fSignalB");
+    BOOST_REQUIRE(DataProcessor::getSkippedMembers(type, kAllData).empty());
+    BOOST_REQUIRE(DataProcessor::getSkippedMembers(
+                    type, kStripData | kDiagramData).empty());
+  }
+}
+
+BOOST_AUTO_TEST_CASE( NothingIsSkippedForSignalFiles )
+{
+  const FileTypes types[] = {FileTypes::fSigCh, FileTypes::fRawSignal,
+                             FileTypes::fNone};
+  for (FileTypes type : types) {
+    BOOST_REQUIRE(DataProcessor::getSkippedMembers(type, kStripData).empty());
+    BOOST_REQUIRE(DataProcessor::getSkippedMembers(type, kAllData).empty());
+  }
+}
+
+BOOST_AUTO_TEST_CASE( DiagramKeepsAllPointsOfFourThresholds )
+{
+  std::vector<JPetSigCh> leading, trailing;
+  makePoints(SignalDiagram::kMaxThresholds, leading, trailing);
+  SignalDiagram diagram;
+  BOOST_REQUIRE_EQUAL(
+    DataProcessor::fillDiagram(leading, trailing, false, diagram), 0u);
+  BOOST_REQUIRE_EQUAL(diagram.size(), SignalDiagram::kMaxPoints);
+  BOOST_REQUIRE_EQUAL(diagram.points[0].thresholdNumber, 1);
+  BOOST_REQUIRE_EQUAL(diagram.points[0].edge, JPetSigCh::Leading);
+  BOOST_REQUIRE_CLOSE(diagram.points[0].time, 1100.f, 1e-3);
+  BOOST_REQUIRE_EQUAL(diagram.points[4].edge, JPetSigCh::Trailing);
+  BOOST_REQUIRE_CLOSE(diagram.points[4].time, 6100.f, 1e-3);
+}
+
+BOOST_AUTO_TEST_CASE( DiagramDropsPointsOfThresholdsAboveMaximum )
+{
+  std::vector<JPetSigCh> leading, trailing;
+  makePoints(SignalDiagram::kMaxThresholds + 2, leading, trailing);
+  SignalDiagram diagram;
+  BOOST_REQUIRE_EQUAL(
+    DataProcessor::fillDiagram(leading, trailing, false, diagram), 4u);
+  BOOST_REQUIRE_EQUAL(diagram.size(), SignalDiagram::kMaxPoints);
+  for (const DiagramPoint& point : diagram)
+    BOOST_REQUIRE(point.thresholdNumber <= SignalDiagram::kMaxThresholds);
+}
+
+BOOST_AUTO_TEST_CASE( ResetLeadingEdgeAlignsThresholds )
+{
+  std::vector<JPetSigCh> leading, trailing;
+  makePoints(2, leading, trailing);
+  SignalDiagram diagram;
+  DataProcessor::fillDiagram(leading, trailing, true, diagram);
+  BOOST_REQUIRE_EQUAL(diagram.size(), 4u);
+  BOOST_REQUIRE_SMALL(diagram.points[1].time, 1e-3f);
+  // every threshold is shifted by its own leading edge
+  BOOST_REQUIRE_CLOSE(diagram.points[2].time, 5000.f, 1e-3);
+  BOOST_REQUIRE_CLOSE(diagram.points[3].time, 5000.f, 1e-3);
 }
 
-BOOST_AUTO_TEST_SUITE_END()
\ No newline at end of file
+BOOST_AUTO_TEST_SUITE_END()
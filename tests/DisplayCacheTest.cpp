@@ -0,0 +1,110 @@
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MODULE DisplayCacheTest
+#include <boost/test/unit_test.hpp>
+
+#include "../src/DisplayCache.h"
+#include "./TestHelpers.h"
+#include <fstream>
+
+using namespace jpet_event_display;
+
+namespace
+{
+DiagramPoint makePoint(int threshold, float time, JPetSigCh::EdgeType edge)
+{
+  DiagramPoint point;
+  point.thresholdNumber = threshold;
+  point.thresholdValue = 80.f * threshold;
+  point.time = time;
+  point.edge = edge;
+  return point;
+}
+} // namespace
+
+BOOST_AUTO_TEST_SUITE(FirstSuite)
+
+BOOST_AUTO_TEST_CASE( WrittenFramesAreReadBack )
+{
+  TemporaryFile dataFile("displayCacheTestData.txt", "data");
+  const std::string& dataFileName = dataFile.getName();
+  const std::string cacheFileName = display_cache::getCacheFileName(dataFileName);
+  dataFile.addDerivedFile(cacheFileName);
+  dataFile.addDerivedFile(cacheFileName + ".tmp");
+
+  DisplayCacheWriter writer;
+  BOOST_REQUIRE(writer.open(cacheFileName, dataFileName));
+  DisplayFrame frame;
+  frame.setCurrentFileType(FileTypes::fRawSignal);
+  frame.getActivedScintilators().add(1, 5, 3);
+  frame.getActivedScintilators().add(2, 7);
+  SignalDiagram diagram;
+  diagram.layer = 1;
+  diagram.slot = 5;
+  diagram.addPoint(makePoint(1, 10.f, JPetSigCh::Leading));
+  diagram.addPoint(makePoint(1, 25.f, JPetSigCh::Trailing));
+  frame.getDiagramData().push_back(diagram);
+  frame.getHits().emplace_back(1., 2., 3.);
+  frame.getHitTimes().push_back(1500.);
+  frame.addToInfo("first event");
+  writer.addFrame(frame);
+  frame.clearData();
+  frame.addToInfo("empty event");
+  writer.addFrame(frame);
+  BOOST_REQUIRE(!std::ifstream(cacheFileName.c_str()));
+  BOOST_REQUIRE(writer.close());
+  BOOST_REQUIRE(!std::ifstream((cacheFileName + ".tmp").c_str()));
+
+  DisplayCacheReader reader;
+  BOOST_REQUIRE(reader.open(cacheFileName));
+  BOOST_REQUIRE(reader.matchesDataFile(dataFileName));
+  BOOST_REQUIRE_EQUAL(reader.getNumberOfEvents(), 2);
+  BOOST_REQUIRE_EQUAL(reader.getFileType(), FileTypes::fRawSignal);
+
+  DisplayFrame result;
+  BOOST_REQUIRE(reader.readFrame(0, result, false));
+  BOOST_REQUIRE_EQUAL(result.getInfo(), "first event");
+  BOOST_REQUIRE_EQUAL(result.getActivedScintilators().size(), 2u);
+  BOOST_REQUIRE_EQUAL(result.getActivedScintilators().getNumberOfHits(1, 5), 3u);
+  BOOST_REQUIRE(result.getActivedScintilators().contains(2, 7));
+  BOOST_REQUIRE_EQUAL(result.getDiagramData().size(), 1u);
+  BOOST_REQUIRE_EQUAL(result.getDiagramData()[0].size(), 2u);
+  BOOST_REQUIRE_CLOSE(result.getDiagramData()[0].points[1].time, 25.f, 1e-4);
+  BOOST_REQUIRE_EQUAL(result.getHits().size(), 1u);
+  BOOST_REQUIRE_CLOSE(result.getHits()[0].Z(), 3., 1e-9);
+  BOOST_REQUIRE_EQUAL(result.getHitTimes().size(), 1u);
+  BOOST_REQUIRE_CLOSE(result.getHitTimes()[0], 1500., 1e-9);
+
+  BOOST_REQUIRE(reader.readFrame(1, result, false));
+  BOOST_REQUIRE_EQUAL(result.getInfo(), "empty event");
+  BOOST_REQUIRE(result.getActivedScintilators().empty());
+  BOOST_REQUIRE(result.getDiagramData().empty());
+  BOOST_REQUIRE(!reader.readFrame(2, result, false));
+
+  reader.close();
+}
+
+BOOST_AUTO_TEST_CASE( ResetLeadingEdgeShiftsTrailingByLeadingTime )
+{
+  SignalDiagram diagram;
+  diagram.addPoint(makePoint(1, 10.f, JPetSigCh::Leading));
+  diagram.addPoint(makePoint(2, 12.f, JPetSigCh::Leading));
+  diagram.addPoint(makePoint(2, 20.f, JPetSigCh::Trailing));
+  diagram.addPoint(makePoint(1, 25.f, JPetSigCh::Trailing));
+  DisplayCacheReader::resetLeadingEdge(diagram);
+
+  BOOST_REQUIRE_EQUAL(diagram.points[0].time, 0.f);
+  BOOST_REQUIRE_EQUAL(diagram.points[1].time, 0.f);
+  BOOST_REQUIRE_CLOSE(diagram.points[2].time, 8.f, 1e-4);
+  BOOST_REQUIRE_CLOSE(diagram.points[3].time, 15.f, 1e-4);
+}
+
+BOOST_AUTO_TEST_CASE( CorruptedFileIsRejected )
+{
+  TemporaryFile cacheFile("displayCacheTestCorrupted.evdc",
+                          "not a display cache file");
+  DisplayCacheReader reader;
+  BOOST_REQUIRE(!reader.open(cacheFile.getName()));
+  BOOST_REQUIRE_EQUAL(reader.getNumberOfEvents(), 0);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
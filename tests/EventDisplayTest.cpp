@@ -3,12 +3,46 @@
 #include <boost/test/unit_test.hpp>
 
 #include "../src/EventDisplay.h"
+#include <TROOT.h>
+
+using namespace jpet_event_display;
 
 BOOST_AUTO_TEST_SUITE(FirstSuite)
 
-BOOST_AUTO_TEST_CASE( EventDisplayTests )
-{ 
-  BOOST_REQUIRE(1==0); 
+BOOST_AUTO_TEST_CASE( DiagramTabReadsOnlyDiagramData )
+{
+  unsigned int diagramData =
+    EventDisplay::getRequiredData(GeometryVisualizator::kDiagramView, false);
+  BOOST_REQUIRE(diagramData & kDiagramData);
+  BOOST_REQUIRE(!(diagramData & kHitData));
+  unsigned int topViewData =
+    EventDisplay::getRequiredData(GeometryVisualizator::kTopView, false);
+  BOOST_REQUIRE(topViewData & kHitData);
+  BOOST_REQUIRE(!(topViewData & kDiagramData));
+}
+
+// hidden views keep drawing every shown event, so hits are read on all tabs
+BOOST_AUTO_TEST_CASE( HitsAreReadOnAllTabsWhileAccumulating )
+{
+  gROOT->SetBatch(kTRUE);
+  const std::vector< std::pair< int, double > > layerStats = {{48, 42.5}};
+  GeometryVisualizator visualizator(layerStats.size(), 50, layerStats);
+  visualizator.createBatchCanvases(200, 200);
+  visualizator.showGeometry();
+  visualizator.changeMarkersState();
+  BOOST_REQUIRE(visualizator.isAccumulating());
+  for (int tab = 0; tab < GeometryVisualizator::kNumberOfViews; tab++) {
+    visualizator.setActiveView(static_cast< GeometryVisualizator::View >(tab));
+    BOOST_REQUIRE(EventDisplay::getRequiredData(
+                    visualizator.getActiveView(),
+                    visualizator.isAccumulating()) & kHitData);
+  }
+  visualizator.changeMarkersState();
+  visualizator.changeDensityState();
+  BOOST_REQUIRE(visualizator.isAccumulating());
+  BOOST_REQUIRE(EventDisplay::getRequiredData(
+                  GeometryVisualizator::kDiagramView,
+                  visualizator.isAccumulating()) & kHitData);
 }
 
-BOOST_AUTO_TEST_SUITE_END()
\ No newline at end of file
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,90 @@
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MODULE EventIndexTest
+#include <boost/test/unit_test.hpp>
+
+#include "../src/EventIndex.h"
+#include "./TestHelpers.h"
+#include <fstream>
+
+using namespace jpet_event_display;
+
+BOOST_AUTO_TEST_SUITE(FirstSuite)
+
+BOOST_AUTO_TEST_CASE( EmptyIndex )
+{
+  EventIndex index;
+  long long entry = 0;
+  unsigned int eventInEntry = 0;
+  BOOST_REQUIRE_EQUAL(index.getNumberOfEvents(), 0);
+  BOOST_REQUIRE_EQUAL(index.getNumberOfEntries(), 0);
+  BOOST_REQUIRE(!index.findEvent(0, entry, eventInEntry));
+}
+
+BOOST_AUTO_TEST_CASE( FindEventSkipsEmptyEntries )
+{
+  EventIndex index;
+  index.addEntry(3);
+  index.addEntry(0);
+  index.addEntry(0);
+  index.addEntry(2);
+  BOOST_REQUIRE_EQUAL(index.getNumberOfEvents(), 5);
+  BOOST_REQUIRE_EQUAL(index.getNumberOfEntries(), 4);
+
+  long long entry = 0;
+  unsigned int eventInEntry = 0;
+  BOOST_REQUIRE(index.findEvent(2, entry, eventInEntry));
+  BOOST_REQUIRE_EQUAL(entry, 0);
+  BOOST_REQUIRE_EQUAL(eventInEntry, 2u);
+  BOOST_REQUIRE(index.findEvent(3, entry, eventInEntry));
+  BOOST_REQUIRE_EQUAL(entry, 3);
+  BOOST_REQUIRE_EQUAL(eventInEntry, 0u);
+  BOOST_REQUIRE(index.findEvent(4, entry, eventInEntry));
+  BOOST_REQUIRE_EQUAL(entry, 3);
+  BOOST_REQUIRE_EQUAL(eventInEntry, 1u);
+  BOOST_REQUIRE(!index.findEvent(5, entry, eventInEntry));
+  BOOST_REQUIRE(!index.findEvent(-1, entry, eventInEntry));
+}
+
+BOOST_AUTO_TEST_CASE( LoadWithoutKnownNumberOfEntries )
+{
+  TemporaryFile dataFile("EventIndexTest_data.root", "data");
+  const std::string& dataFileName = dataFile.getName();
+  dataFile.addDerivedFile(EventIndex::getIndexFileName(dataFileName));
+  EventIndex index;
+  index.addEntry(3);
+  index.addEntry(2);
+  BOOST_REQUIRE(index.save(dataFileName));
+
+  EventIndex loaded;
+  BOOST_REQUIRE(loaded.load(dataFileName, -1));
+  BOOST_REQUIRE_EQUAL(loaded.getNumberOfEntries(), 2);
+  BOOST_REQUIRE_EQUAL(loaded.getNumberOfEvents(), 5);
+  BOOST_REQUIRE(!loaded.load(dataFileName, 3));
+}
+
+BOOST_AUTO_TEST_CASE( IndexWithCorruptedNumberOfEntriesIsRejected )
+{
+  TemporaryFile dataFile("EventIndexTest_corrupted.root", "data");
+  const std::string& dataFileName = dataFile.getName();
+  dataFile.addDerivedFile(EventIndex::getIndexFileName(dataFileName));
+  EventIndex index;
+  index.addEntry(3);
+  index.addEntry(2);
+  BOOST_REQUIRE(index.save(dataFileName));
+
+  // number of entries follows magic, version, file size and mtime
+  const long long hugeNumberOfEntries = 1LL << 60;
+  std::fstream indexFile(EventIndex::getIndexFileName(dataFileName).c_str(),
+                         std::ios_base::in | std::ios_base::out |
+                         std::ios_base::binary);
+  indexFile.seekp(8 + 4 + 8 + 8);
+  indexFile.write(reinterpret_cast<const char*>(&hugeNumberOfEntries),
+                  sizeof(hugeNumberOfEntries));
+  indexFile.close();
+
+  EventIndex loaded;
+  BOOST_REQUIRE(!loaded.load(dataFileName, -1));
+  BOOST_REQUIRE_EQUAL(loaded.getNumberOfEvents(), 0);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
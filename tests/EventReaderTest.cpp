@@ -0,0 +1,32 @@
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MODULE EventReaderTest
+#include <boost/test/unit_test.hpp>
+
+#include "../src/EventReader.h"
+
+using namespace jpet_event_display;
+
+BOOST_AUTO_TEST_SUITE(FirstSuite)
+
+BOOST_AUTO_TEST_CASE( MemberIsWholeComponentOfBranchName )
+{
+  BOOST_REQUIRE(EventReader::isMemberBranch("fSignalA", "fSignalA"));
+  BOOST_REQUIRE(EventReader::isMemberBranch("fEvents.fHits.fSignalA",
+                "fSignalA"));
+  BOOST_REQUIRE(EventReader::isMemberBranch("fEvents.fSignalB.fRecoSignal",
+                "fSignalB"));
+  BOOST_REQUIRE(EventReader::isMemberBranch("fEvents.fSignalA[2]",
+                "fSignalA"));
+  BOOST_REQUIRE(!EventReader::isMemberBranch("fEvents.fSignalAB", "fSignalA"));
+  BOOST_REQUIRE(!EventReader::isMemberBranch("fEvents.xfSignalA", "fSignalA"));
+  BOOST_REQUIRE(!EventReader::isMemberBranch("fEvents.fHits", "fSignalA"));
+  BOOST_REQUIRE(!EventReader::isMemberBranch("fEvents", ""));
+}
+
+BOOST_AUTO_TEST_CASE( NothingIsSkippedWithoutOpenedFile )
+{
+  EventReader reader;
+  BOOST_REQUIRE_EQUAL(reader.skipMembers({"fSignalA"}), 0);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,108 @@
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MODULE FileChainTest
+#include <boost/test/unit_test.hpp>
+
+#include "../src/FileChain.h"
+#include "./TestHelpers.h"
+#include <deque>
+
+using namespace jpet_event_display;
+
+namespace
+{
+// data files with their saved indices are removed at the end of a test
+void addDataFile(const std::string& fileName, std::deque<TemporaryFile>& files,
+                 std::vector<std::string>& fileNames)
+{
+  files.emplace_back(fileName, "data");
+  files.back().addDerivedFile(EventIndex::getIndexFileName(fileName));
+  fileNames.push_back(fileName);
+}
+} // namespace
+
+BOOST_AUTO_TEST_SUITE(FirstSuite)
+
+BOOST_AUTO_TEST_CASE( ExpandCommaSeparatedList )
+{
+  std::vector<std::string> fileNames =
+    FileChain::expandFileNames("a.root,b.root,,c.root");
+  BOOST_REQUIRE_EQUAL(fileNames.size(), 3u);
+  BOOST_REQUIRE_EQUAL(fileNames[0], "a.root");
+  BOOST_REQUIRE_EQUAL(fileNames[2], "c.root");
+}
+
+BOOST_AUTO_TEST_CASE( ExistingFileWithCommaIsNotSplit )
+{
+  TemporaryFile file("FileChainTest_a,b.root", "data");
+  std::vector<std::string> fileNames =
+    FileChain::expandFileNames(file.getName());
+  BOOST_REQUIRE_EQUAL(fileNames.size(), 1u);
+  BOOST_REQUIRE_EQUAL(fileNames[0], file.getName());
+}
+
+BOOST_AUTO_TEST_CASE( ExpandListFile )
+{
+  TemporaryFile listFile("FileChainTest_list.txt",
+                         "# run 1\n a.root \n\nb.root\n");
+  std::vector<std::string> fileNames =
+    FileChain::expandFileNames(listFile.getName());
+  BOOST_REQUIRE_EQUAL(fileNames.size(), 2u);
+  BOOST_REQUIRE_EQUAL(fileNames[0], "a.root");
+  BOOST_REQUIRE_EQUAL(fileNames[1], "b.root");
+}
+
+// data files are not valid ROOT files, so chain must use only saved indices
+BOOST_AUTO_TEST_CASE( GlobalEventNumbersFromSavedIndices )
+{
+  const unsigned int eventsInFile[] = {5, 0, 3};
+  std::deque<TemporaryFile> files;
+  std::vector<std::string> fileNames;
+  for (unsigned int i = 0; i < 3; i++) {
+    addDataFile("FileChainTest_" + std::to_string(i) + ".root", files,
+                fileNames);
+    EventIndex index;
+    index.addEntry(eventsInFile[i]);
+    BOOST_REQUIRE(index.save(fileNames.back()));
+  }
+
+  FileChain chain(fileNames);
+  BOOST_REQUIRE(chain.isComplete());
+  BOOST_REQUIRE_EQUAL(chain.getNumberOfEvents(), 8);
+  size_t file = 0;
+  long long eventInFile = 0;
+  BOOST_REQUIRE_EQUAL(chain.findEvent(4, file, eventInFile), FileChain::kFound);
+  BOOST_REQUIRE_EQUAL(file, 0u);
+  BOOST_REQUIRE_EQUAL(eventInFile, 4);
+  BOOST_REQUIRE_EQUAL(chain.findEvent(5, file, eventInFile), FileChain::kFound);
+  BOOST_REQUIRE_EQUAL(file, 2u);
+  BOOST_REQUIRE_EQUAL(eventInFile, 0);
+  BOOST_REQUIRE_EQUAL(chain.findEvent(8, file, eventInFile),
+                      FileChain::kNotFound);
+}
+
+// the second file has no saved index and is not a ROOT file
+BOOST_AUTO_TEST_CASE( UnreadableFileIsCountedAsEmpty )
+{
+  std::deque<TemporaryFile> files;
+  std::vector<std::string> fileNames;
+  addDataFile("FileChainTest_indexed.root", files, fileNames);
+  addDataFile("FileChainTest_broken.root", files, fileNames);
+  EventIndex index;
+  index.addEntry(4);
+  BOOST_REQUIRE(index.save(fileNames[0]));
+
+  FileChain chain(fileNames);
+  BOOST_REQUIRE(!chain.isComplete());
+  size_t file = 0;
+  long long eventInFile = 0;
+  BOOST_REQUIRE_EQUAL(chain.findEvent(3, file, eventInFile), FileChain::kFound);
+  BOOST_REQUIRE_EQUAL(chain.findEvent(4, file, eventInFile),
+                      FileChain::kNotCountedYet);
+  chain.startCounting();
+  BOOST_REQUIRE(chain.waitForCounting());
+  BOOST_REQUIRE_EQUAL(chain.getNumberOfEvents(), 4);
+  BOOST_REQUIRE_EQUAL(chain.findEvent(4, file, eventInFile),
+                      FileChain::kNotFound);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,54 @@
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MODULE FrameCacheTest
+#include <boost/test/unit_test.hpp>
+
+#include "../src/FrameCache.h"
+
+using namespace jpet_event_display;
+
+BOOST_AUTO_TEST_SUITE(FirstSuite)
+
+BOOST_AUTO_TEST_CASE( GetReturnsStoredFrame )
+{
+  FrameCache cache;
+  DisplayFrame frame;
+  frame.addToInfo("event 7");
+  cache.put(7, frame);
+
+  DisplayFrame result;
+  BOOST_REQUIRE(cache.get(7, result));
+  BOOST_REQUIRE_EQUAL(result.getInfo(), "event 7");
+  BOOST_REQUIRE(!cache.get(8, result));
+}
+
+BOOST_AUTO_TEST_CASE( LeastRecentlyUsedFrameIsEvicted )
+{
+  DisplayFrame frame;
+  frame.addToInfo("frame");
+  FrameCache cache(2 * frame.getMemorySize());
+  cache.put(1, frame);
+  cache.put(2, frame);
+  DisplayFrame result;
+  BOOST_REQUIRE(cache.get(1, result));
+  cache.put(3, frame);
+
+  BOOST_REQUIRE_EQUAL(cache.getNumberOfFrames(), 2u);
+  BOOST_REQUIRE(cache.get(1, result));
+  BOOST_REQUIRE(!cache.get(2, result));
+  BOOST_REQUIRE(cache.get(3, result));
+}
+
+BOOST_AUTO_TEST_CASE( ShrinkingBudgetEvictsFrames )
+{
+  DisplayFrame frame;
+  FrameCache cache;
+  cache.put(1, frame);
+  cache.put(2, frame);
+  cache.setMemoryBudget(frame.getMemorySize());
+  BOOST_REQUIRE_EQUAL(cache.getNumberOfFrames(), 1u);
+  BOOST_REQUIRE(cache.getMemoryUsage() <= cache.getMemoryBudget());
+  cache.clear();
+  BOOST_REQUIRE_EQUAL(cache.getMemoryUsage(), 0u);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,52 @@
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MODULE FramePrimitivesTest
+#include <boost/test/unit_test.hpp>
+
+#include "../src/FramePrimitives.h"
+#include <TMarker.h>
+
+using namespace jpet_event_display;
+
+BOOST_AUTO_TEST_SUITE(FirstSuite)
+
+BOOST_AUTO_TEST_CASE( ReleasedObjectsAreReused )
+{
+  FramePrimitives primitives;
+  TMarker* first = primitives.create<TMarker>();
+  TMarker* second = primitives.create<TMarker>();
+  BOOST_REQUIRE(first != second);
+  BOOST_REQUIRE_EQUAL(primitives.size(), 2u);
+  primitives.release();
+  BOOST_REQUIRE_EQUAL(primitives.size(), 0u);
+  BOOST_REQUIRE_EQUAL(primitives.create<TMarker>(), first);
+  BOOST_REQUIRE_EQUAL(primitives.create<TMarker>(), second);
+  BOOST_REQUIRE_EQUAL(primitives.getNumberOfAllocated(), 2u);
+}
+
+BOOST_AUTO_TEST_CASE( AllocatedObjectsAreBoundedByBiggestFrame )
+{
+  FramePrimitives primitives;
+  for (int frame = 0; frame < 100; frame++) {
+    primitives.release();
+    for (int i = 0; i < frame % 5; i++) {
+      primitives.create<TPolyLine>();
+      primitives.create<TPolyMarker3D>();
+    }
+  }
+  BOOST_REQUIRE_EQUAL(primitives.getNumberOfAllocated(), 8u);
+}
+
+BOOST_AUTO_TEST_CASE( RecycledLinesHaveNoPoints )
+{
+  FramePrimitives primitives;
+  TPolyLine* line = primitives.create<TPolyLine>();
+  line->SetNextPoint(1., 2.);
+  line->SetNextPoint(3., 4.);
+  TPolyLine3D* line3d = primitives.create<TPolyLine3D>();
+  line3d->SetNextPoint(1., 2., 3.);
+  primitives.release();
+  BOOST_REQUIRE_EQUAL(primitives.create<TPolyLine>()->Size(), 0);
+  BOOST_REQUIRE_EQUAL(primitives.create<TPolyLine3D>()->Size(), 0);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -3,12 +3,214 @@
 #include <boost/test/unit_test.hpp>
 
 #include "../src/GeometryVisualizator.h"
+#include <TCanvas.h>
+#include <TROOT.h>
+
+using namespace jpet_event_display;
+
+namespace
+{
+const std::vector< std::pair< int, double > > kLayerStats = {
+  {48, 42.5}, {48, 46.75}, {96, 57.5}
+};
+
+// canvases are offscreen, views are drawn as in batch rendering
+std::unique_ptr< GeometryVisualizator > createVisualizator(
+  const std::vector< std::pair< int, double > >& layerStats = kLayerStats)
+{
+  gROOT->SetBatch(kTRUE);
+  std::unique_ptr< GeometryVisualizator > visualizator(
+    new GeometryVisualizator(layerStats.size(), 50, layerStats));
+  visualizator->createBatchCanvases(200, 200);
+  visualizator->showGeometry();
+  return visualizator;
+}
+
+const Color_t kHighlightColor = 2; // red of the basic palette
+
+Color_t getStripColor(size_t layer, size_t slot)
+{
+  return gGeoManager->GetTopNode()->GetDaughter(layer - 1)->GetDaughter(
+           slot - 1)->GetVolume()->GetLineColor();
+}
+
+void setShownFrame(size_t layer, size_t slot)
+{
+  ProcessedData& data = ProcessedData::getInstance();
+  data.clearData();
+  data.getActivedScintilators().add(layer, slot);
+  data.getHits().emplace_back(10., 20., 0.);
+}
+
+// every signal has a leading edge, trailing edges only if withTrailing is set
+void setShownDiagrams(unsigned int numberOfSignals, bool withTrailing)
+{
+  SignalDiagrams& diagrams = ProcessedData::getInstance().getDiagramData();
+  diagrams.clear();
+  for (unsigned int i = 0; i < numberOfSignals; i++) {
+    SignalDiagram diagram;
+    diagram.layer = 1;
+    diagram.slot = i + 1;
+    diagram.addPoint({1, 80.f, 1000.f, JPetSigCh::Leading});
+    if (withTrailing)
+      diagram.addPoint({1, 80.f, 5000.f, JPetSigCh::Trailing});
+    diagrams.push_back(diagram);
+  }
+}
+} // namespace
 
 BOOST_AUTO_TEST_SUITE(FirstSuite)
 
-BOOST_AUTO_TEST_CASE( GeometryVisualizatorTests )
-{ 
-  BOOST_REQUIRE(1==0); 
+BOOST_AUTO_TEST_CASE( OnlyActiveViewIsDrawn )
+{
+  std::unique_ptr< GeometryVisualizator > visualizator = createVisualizator();
+  setShownFrame(1, 5);
+  visualizator->setActiveView(GeometryVisualizator::k3dView);
+  visualizator->drawData();
+  BOOST_REQUIRE(!visualizator->isViewOutdated(GeometryVisualizator::k3dView));
+  BOOST_REQUIRE(visualizator->isViewOutdated(GeometryVisualizator::kTopView));
+  BOOST_REQUIRE(
+    visualizator->isViewOutdated(GeometryVisualizator::kDiagramView));
+
+  visualizator->setActiveView(GeometryVisualizator::kTopView);
+  visualizator->updateActiveView();
+  BOOST_REQUIRE(!visualizator->isViewOutdated(GeometryVisualizator::kTopView));
+  BOOST_REQUIRE(
+    visualizator->isViewOutdated(GeometryVisualizator::kUnrolledView));
+}
+
+BOOST_AUTO_TEST_CASE( SavedMarkersDrawAllViewsExceptDiagrams )
+{
+  std::unique_ptr< GeometryVisualizator > visualizator = createVisualizator();
+  visualizator->changeMarkersState();
+  setShownFrame(2, 7);
+  visualizator->setActiveView(GeometryVisualizator::k3dView);
+  visualizator->drawData();
+  BOOST_REQUIRE(!visualizator->isViewOutdated(GeometryVisualizator::k3dView));
+  BOOST_REQUIRE(
+    !visualizator->isViewOutdated(GeometryVisualizator::kUnrolledView));
+  BOOST_REQUIRE(!visualizator->isViewOutdated(GeometryVisualizator::kTopView));
+  BOOST_REQUIRE(
+    visualizator->isViewOutdated(GeometryVisualizator::kDiagramView));
+}
+
+BOOST_AUTO_TEST_CASE( HighlightedStripIsResetOnNextEvent )
+{
+  std::unique_ptr< GeometryVisualizator > visualizator = createVisualizator();
+  Color_t layerColor = getStripColor(1, 5);
+  setShownFrame(1, 5);
+  visualizator->drawData();
+  BOOST_REQUIRE_EQUAL(visualizator->getNumberOfHighlightedStrips(), 1u);
+  BOOST_REQUIRE_EQUAL(getStripColor(1, 5), kHighlightColor);
+
+  setShownFrame(3, 90);
+  visualizator->drawData();
+  BOOST_REQUIRE_EQUAL(visualizator->getNumberOfHighlightedStrips(), 1u);
+  BOOST_REQUIRE_EQUAL(getStripColor(1, 5), layerColor);
+  BOOST_REQUIRE_EQUAL(getStripColor(3, 90), kHighlightColor);
+}
+
+BOOST_AUTO_TEST_CASE( StripsOfFourthLayerAreReset )
+{
+  std::vector< std::pair< int, double > > layerStats = kLayerStats;
+  layerStats.push_back(std::make_pair(96, 61.));
+  std::unique_ptr< GeometryVisualizator > visualizator =
+    createVisualizator(layerStats);
+  Color_t layerColor = getStripColor(4, 10);
+  setShownFrame(4, 10);
+  visualizator->drawData();
+  BOOST_REQUIRE_EQUAL(getStripColor(4, 10), kHighlightColor);
+  setShownFrame(1, 1);
+  visualizator->drawData();
+  BOOST_REQUIRE_EQUAL(getStripColor(4, 10), layerColor);
+
+  StripOccupancy occupancy;
+  occupancy.setLayerSizes({48, 48, 96, 96});
+  occupancy.add(1, 1, 3);
+  visualizator->drawOccupancy(occupancy);
+  BOOST_REQUIRE_EQUAL(getStripColor(4, 10), layerColor);
+  visualizator->drawData(); // all strips are reset after occupancy
+  BOOST_REQUIRE_EQUAL(visualizator->getNumberOfHighlightedStrips(), 1u);
+  BOOST_REQUIRE_EQUAL(getStripColor(4, 10), layerColor);
+}
+
+BOOST_AUTO_TEST_CASE( DiagramPadObjectsAreReused )
+{
+  std::unique_ptr< GeometryVisualizator > visualizator = createVisualizator();
+  visualizator->setActiveView(GeometryVisualizator::kDiagramView);
+  setShownFrame(1, 1);
+  setShownDiagrams(4, true);
+  visualizator->drawData();
+  TCanvas* canvas = dynamic_cast< TCanvas* >(
+                      gROOT->GetListOfCanvases()->FindObject("diagramCanvas"));
+  BOOST_REQUIRE(canvas);
+  TVirtualPad* pad = canvas->GetPad(1);
+  BOOST_REQUIRE(pad);
+  TObject* frame = pad->GetListOfPrimitives()->FindObject("diagramFrame0");
+  BOOST_REQUIRE(frame);
+  // frame, leading and trailing edges and lines of thresholds
+  BOOST_REQUIRE_EQUAL(pad->GetListOfPrimitives()->GetSize(),
+                      3 + SignalDiagram::kMaxThresholds);
+
+  // the same number of signals, pads are not divided again
+  setShownDiagrams(4, true);
+  visualizator->drawData();
+  BOOST_REQUIRE_EQUAL(canvas->GetPad(1), pad);
+  BOOST_REQUIRE_EQUAL(pad->GetListOfPrimitives()->FindObject("diagramFrame0"),
+                      frame);
+
+  setShownDiagrams(2, false);
+  visualizator->drawData();
+  BOOST_REQUIRE(!canvas->GetPad(3));
+  pad = canvas->GetPad(1);
+  BOOST_REQUIRE(pad);
+  BOOST_REQUIRE_EQUAL(pad->GetListOfPrimitives()->FindObject("diagramFrame0"),
+                      frame);
+  BOOST_REQUIRE_EQUAL(pad->GetListOfPrimitives()->GetSize(),
+                      2 + SignalDiagram::kMaxThresholds);
+}
+
+BOOST_AUTO_TEST_CASE( DensityNeedsCanvases )
+{
+  gROOT->SetBatch(kTRUE);
+  GeometryVisualizator visualizator(kLayerStats.size(), 50, kLayerStats);
+  visualizator.changeDensityState();
+  BOOST_REQUIRE(!visualizator.isShowingDensity());
+}
+
+BOOST_AUTO_TEST_CASE( DensityIsFilledOnAllMarkerViews )
+{
+  std::unique_ptr< GeometryVisualizator > visualizator = createVisualizator();
+  // frame is already on the pad when density is enabled
+  visualizator->setActiveView(GeometryVisualizator::kTopView);
+  setShownFrame(1, 5);
+  visualizator->drawData();
+  visualizator->changeDensityState();
+  BOOST_REQUIRE(visualizator->isShowingDensity());
+  visualizator->setActiveView(GeometryVisualizator::kUnrolledView);
+  setShownFrame(1, 5);
+  visualizator->drawData();
+  setShownFrame(2, 7);
+  visualizator->drawData();
+  BOOST_REQUIRE(!visualizator->isViewOutdated(GeometryVisualizator::kTopView));
+  // 3d view has no density, it is drawn when shown
+  BOOST_REQUIRE(visualizator->isViewOutdated(GeometryVisualizator::k3dView));
+  BOOST_REQUIRE(
+    visualizator->isViewOutdated(GeometryVisualizator::kDiagramView));
+
+  TCanvas* canvas = dynamic_cast< TCanvas* >(
+                      gROOT->GetListOfCanvases()->FindObject("canvasTopView"));
+  BOOST_REQUIRE(canvas);
+  TH2F* density = dynamic_cast< TH2F* >(
+                    canvas->GetListOfPrimitives()->FindObject("topViewDensity"));
+  BOOST_REQUIRE(density);
+  BOOST_REQUIRE_EQUAL(density->GetEntries(), 2.);
+  // line of current event is painted over the histogram
+  BOOST_REQUIRE(canvas->GetListOfPrimitives()->Last() != density);
+
+  visualizator->changeDensityState();
+  BOOST_REQUIRE(!visualizator->isShowingDensity());
+  BOOST_REQUIRE(!canvas->GetListOfPrimitives()->FindObject("topViewDensity"));
 }
 
-BOOST_AUTO_TEST_SUITE_END()
\ No newline at end of file
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,50 @@
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MODULE OccupancyScannerTest
+#include <boost/test/unit_test.hpp>
+
+#include "../src/OccupancyScanner.h"
+
+using namespace jpet_event_display;
+
+BOOST_AUTO_TEST_SUITE(FirstSuite)
+
+BOOST_AUTO_TEST_CASE( AddCountsHitsOfActivedStrips )
+{
+  ScintillatorsInLayers selection;
+  selection.add(1, 5);
+  selection.add(1, 5);
+  selection.add(3, 96);
+
+  StripOccupancy occupancy;
+  occupancy.setLayerSizes({48, 48, 96});
+  occupancy.add(selection);
+  occupancy.add(selection);
+  BOOST_REQUIRE_EQUAL(occupancy.get(1, 5), 4u);
+  BOOST_REQUIRE_EQUAL(occupancy.get(3, 96), 2u);
+  BOOST_REQUIRE_EQUAL(occupancy.get(2, 5), 0u);
+  BOOST_REQUIRE_EQUAL(occupancy.get(0, 5), 0u);
+  BOOST_REQUIRE_EQUAL(occupancy.getMaximum(), 4u);
+  BOOST_REQUIRE_EQUAL(occupancy.getTotal(), 6u);
+}
+
+BOOST_AUTO_TEST_CASE( MergeSumsAccumulators )
+{
+  StripOccupancy first;
+  first.setLayerSizes({48});
+  first.add(1, 1, 10);
+  StripOccupancy second;
+  second.setLayerSizes({48});
+  second.add(1, 1, 5);
+  second.add(2, 3, 7); // outside of given geometry
+
+  first.merge(second);
+  BOOST_REQUIRE_EQUAL(first.get(1, 1), 15u);
+  BOOST_REQUIRE_EQUAL(first.get(2, 3), 7u);
+  BOOST_REQUIRE_EQUAL(first.getTotal(), 22u);
+
+  first.reset();
+  BOOST_REQUIRE_EQUAL(first.getTotal(), 0u);
+  BOOST_REQUIRE_EQUAL(first.getMaximum(), 0u);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,46 @@
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MODULE PlaybackClockTest
+#include <boost/test/unit_test.hpp>
+
+#include "../src/PlaybackClock.h"
+
+using namespace jpet_event_display;
+typedef PlaybackClock::Clock Clock;
+
+BOOST_AUTO_TEST_SUITE(FirstSuite)
+
+BOOST_AUTO_TEST_CASE( OneEventIsDuePerPeriod )
+{
+  PlaybackClock clock;
+  Clock::time_point start = Clock::now();
+  clock.start(10., start);
+  BOOST_REQUIRE_EQUAL(clock.advance(start + std::chrono::milliseconds(50)), 0u);
+  BOOST_REQUIRE_EQUAL(clock.advance(start + std::chrono::milliseconds(110)), 1u);
+  BOOST_REQUIRE_EQUAL(clock.advance(start + std::chrono::milliseconds(150)), 0u);
+  BOOST_REQUIRE_EQUAL(clock.advance(start + std::chrono::milliseconds(210)), 1u);
+  BOOST_REQUIRE_EQUAL(clock.getSkipped(), 0u);
+}
+
+BOOST_AUTO_TEST_CASE( LateTickSkipsFrames )
+{
+  PlaybackClock clock;
+  Clock::time_point start = Clock::now();
+  clock.start(10., start);
+  BOOST_REQUIRE_EQUAL(clock.advance(start + std::chrono::milliseconds(450)), 4u);
+  BOOST_REQUIRE_EQUAL(clock.getSkipped(), 3u);
+  BOOST_REQUIRE_EQUAL(clock.advance(start + std::chrono::milliseconds(510)), 1u);
+  BOOST_REQUIRE_EQUAL(clock.getSkipped(), 3u);
+}
+
+BOOST_AUTO_TEST_CASE( FramesPerSecondIsMeasuredOverSecond )
+{
+  PlaybackClock clock;
+  Clock::time_point start = Clock::now();
+  clock.start(100., start);
+  for (int i = 1; i < 20; i++)
+    BOOST_REQUIRE(!clock.frameShown(start + std::chrono::milliseconds(50 * i)));
+  BOOST_REQUIRE(clock.frameShown(start + std::chrono::milliseconds(1000)));
+  BOOST_REQUIRE_CLOSE(clock.getFramesPerSecond(), 20., 1e-6);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,56 @@
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MODULE PointAccumulatorTest
+#include <boost/test/unit_test.hpp>
+
+#include "../src/PointAccumulator.h"
+#include <algorithm>
+
+using namespace jpet_event_display;
+
+BOOST_AUTO_TEST_SUITE(FirstSuite)
+
+BOOST_AUTO_TEST_CASE( OldestPointsAreReplacedWhenFull )
+{
+  PointAccumulator accumulator(3);
+  for (int i = 0; i < 5; i++)
+    BOOST_REQUIRE(accumulator.add(i, 0.f));
+  BOOST_REQUIRE_EQUAL(accumulator.size(), 3u);
+  std::vector<float> xs;
+  for (const auto& point : accumulator.getPoints())
+    xs.push_back(point.x);
+  std::sort(xs.begin(), xs.end());
+  BOOST_REQUIRE_EQUAL(xs[0], 2.f);
+  BOOST_REQUIRE_EQUAL(xs[1], 3.f);
+  BOOST_REQUIRE_EQUAL(xs[2], 4.f);
+}
+
+BOOST_AUTO_TEST_CASE( PointsInOccupiedCellAreSkipped )
+{
+  PointAccumulator accumulator(10, 1.);
+  BOOST_REQUIRE(accumulator.add(0.1f, 0.1f, 0.1f));
+  BOOST_REQUIRE(!accumulator.add(0.9f, 0.5f, 0.2f));
+  BOOST_REQUIRE(accumulator.add(1.1f, 0.5f, 0.2f));
+  BOOST_REQUIRE(accumulator.add(-0.1f, 0.5f, 0.2f));
+  BOOST_REQUIRE_EQUAL(accumulator.size(), 3u);
+}
+
+BOOST_AUTO_TEST_CASE( ReplacedPointFreesItsCell )
+{
+  PointAccumulator accumulator(1, 1.);
+  BOOST_REQUIRE(accumulator.add(0.5f, 0.5f));
+  BOOST_REQUIRE(accumulator.add(5.5f, 0.5f));
+  BOOST_REQUIRE(accumulator.add(0.5f, 0.5f));
+  BOOST_REQUIRE_EQUAL(accumulator.size(), 1u);
+  BOOST_REQUIRE_EQUAL(accumulator.getPoints()[0].x, 0.5f);
+}
+
+BOOST_AUTO_TEST_CASE( ChangingLimitsClearsPoints )
+{
+  PointAccumulator accumulator(10);
+  accumulator.add(1.f, 1.f);
+  accumulator.setLimits(20, 0.5);
+  BOOST_REQUIRE_EQUAL(accumulator.size(), 0u);
+  BOOST_REQUIRE_EQUAL(accumulator.getCapacity(), 20u);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,69 @@
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MODULE ScintillatorsInLayersTest
+#include <boost/test/unit_test.hpp>
+
+#include "../src/ScintillatorsInLayers.h"
+
+using namespace jpet_event_display;
+
+BOOST_AUTO_TEST_SUITE(FirstSuite)
+
+BOOST_AUTO_TEST_CASE( AddCountsHitsInStrip )
+{
+  ScintillatorsInLayers selection;
+  BOOST_REQUIRE(selection.empty());
+  selection.add(1, 5);
+  selection.add(3, 96);
+  selection.add(1, 5);
+
+  BOOST_REQUIRE_EQUAL(selection.size(), 2u);
+  BOOST_REQUIRE(selection.contains(1, 5));
+  BOOST_REQUIRE(selection.contains(3, 96));
+  BOOST_REQUIRE(!selection.contains(2, 5));
+  BOOST_REQUIRE_EQUAL(selection.getNumberOfHits(1, 5), 2u);
+  BOOST_REQUIRE_EQUAL(selection.getNumberOfHits(3, 96), 1u);
+  BOOST_REQUIRE_EQUAL(selection.getNumberOfHits(2, 1), 0u);
+}
+
+BOOST_AUTO_TEST_CASE( IterationFollowsActivationOrder )
+{
+  ScintillatorsInLayers selection;
+  selection.add(2, 7);
+  selection.add(1, 3);
+  selection.add(2, 7);
+  auto it = selection.begin();
+  BOOST_REQUIRE_EQUAL(it->layer, 2u);
+  BOOST_REQUIRE_EQUAL(it->slot, 7u);
+  BOOST_REQUIRE_EQUAL(it->hits, 2u);
+  ++it;
+  BOOST_REQUIRE_EQUAL(it->layer, 1u);
+  BOOST_REQUIRE_EQUAL(it->slot, 3u);
+  ++it;
+  BOOST_REQUIRE(it == selection.end());
+}
+
+BOOST_AUTO_TEST_CASE( ClearRemovesAllStrips )
+{
+  ScintillatorsInLayers selection;
+  selection.add(1, 48);
+  selection.add(0, 1);
+  selection.add(1, 0);
+  BOOST_REQUIRE_EQUAL(selection.size(), 1u);
+  selection.clear();
+  BOOST_REQUIRE(selection.empty());
+  BOOST_REQUIRE(!selection.contains(1, 48));
+  selection.add(1, 48);
+  BOOST_REQUIRE_EQUAL(selection.getNumberOfHits(1, 48), 1u);
+}
+
+// memory depends on number of fired strips, not on strip numbers
+BOOST_AUTO_TEST_CASE( MemoryDoesNotDependOnDetectorSize )
+{
+  ScintillatorsInLayers small;
+  small.add(1, 1);
+  ScintillatorsInLayers large;
+  large.add(100, 100000);
+  BOOST_REQUIRE_EQUAL(small.getMemorySize(), large.getMemorySize());
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,89 @@
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MODULE StageTimerTest
+#include <boost/test/unit_test.hpp>
+
+#include "../src/StageTimer.h"
+#include "./TestHelpers.h"
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <thread>
+
+using namespace jpet_event_display;
+
+BOOST_AUTO_TEST_SUITE(FirstSuite)
+
+BOOST_AUTO_TEST_CASE( NothingIsRecordedWhenDisabled )
+{
+  Profiler& profiler = Profiler::getInstance();
+  profiler.setEnabled(false);
+  profiler.reset();
+  {
+    ScopedTimer timer("disabledStage");
+  }
+  double milliseconds = 0.;
+  BOOST_REQUIRE(!profiler.getAverage("disabledStage", milliseconds));
+  BOOST_REQUIRE_EQUAL(profiler.getCount("disabledStage"), 0u);
+}
+
+BOOST_AUTO_TEST_CASE( AverageCoversLastDurations )
+{
+  Profiler& profiler = Profiler::getInstance();
+  profiler.setEnabled(true);
+  profiler.reset();
+  Profiler::Clock::time_point start = Profiler::Clock::now();
+  profiler.record("stage", start, start + std::chrono::milliseconds(100));
+  for (size_t i = 0; i < Profiler::kWindowSize; i++)
+    profiler.record("stage", start, start + std::chrono::milliseconds(2));
+  double milliseconds = 0.;
+  BOOST_REQUIRE(profiler.getAverage("stage", milliseconds));
+  BOOST_REQUIRE_CLOSE(milliseconds, 2., 1e-6);
+  BOOST_REQUIRE_EQUAL(profiler.getCount("stage"), Profiler::kWindowSize + 1);
+  BOOST_REQUIRE_CLOSE(profiler.getTotal("stage"),
+                      100. + 2. * Profiler::kWindowSize, 1e-6);
+  BOOST_REQUIRE_EQUAL(profiler.getTotal("unknownStage"), 0.);
+  profiler.setEnabled(false);
+}
+
+BOOST_AUTO_TEST_CASE( OtherThreadsAreNotAveraged )
+{
+  Profiler& profiler = Profiler::getInstance();
+  profiler.setEnabled(true);
+  profiler.reset();
+  std::thread worker([]() {
+    ScopedTimer timer("workerStage");
+  });
+  worker.join();
+  {
+    ScopedTimer timer("ownStage");
+  }
+  BOOST_REQUIRE_EQUAL(profiler.getCount("workerStage"), 0u);
+  BOOST_REQUIRE_EQUAL(profiler.getCount("ownStage"), 1u);
+  std::ostringstream summary;
+  profiler.printSummary(summary);
+  BOOST_REQUIRE_EQUAL(summary.str().substr(0, 13), "ownStage: 1 x");
+  profiler.setEnabled(false);
+}
+
+BOOST_AUTO_TEST_CASE( TraceIsWrittenAsCsv )
+{
+  Profiler& profiler = Profiler::getInstance();
+  profiler.setEnabled(true);
+  profiler.setTracing(true);
+  profiler.reset();
+  {
+    ScopedTimer timer("tracedStage");
+  }
+  TemporaryFile traceFile("stageTimerTest.csv");
+  BOOST_REQUIRE(profiler.dumpTrace(traceFile.getName()));
+  std::ifstream in(traceFile.getName().c_str());
+  std::string header, line;
+  std::getline(in, header);
+  std::getline(in, line);
+  BOOST_REQUIRE_EQUAL(header, "stage,thread,start_us,duration_us");
+  BOOST_REQUIRE_EQUAL(line.substr(0, 12), "tracedStage,");
+  profiler.setTracing(false);
+  profiler.setEnabled(false);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
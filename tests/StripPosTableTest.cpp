@@ -0,0 +1,92 @@
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MODULE StripPosTableTest
+#include <boost/test/unit_test.hpp>
+
+#include "../src/ScintillatorsInLayers.h"
+#include "../src/StripPosTable.h"
+#include "./TestHelpers.h"
+#include <JPetParamManager/JPetParamManager.h>
+#include <memory>
+
+using namespace jpet_event_display;
+
+namespace
+{
+const char* kGeometryFileName = "StripPosTableTest_geometry.json";
+const std::vector<int> kStripsInLayers = {4, 8};
+
+struct SmallBarrel {
+  SmallBarrel() : manager(new JPetParamGetterAscii(kGeometryFileName))
+  {
+    manager.fillParameterBank(0);
+    mapper = std::unique_ptr<JPetGeomMapping>(
+               new JPetGeomMapping(manager.getParamBank()));
+  }
+
+  JPetParamManager manager;
+  std::unique_ptr<JPetGeomMapping> mapper;
+};
+} // namespace
+
+BOOST_AUTO_TEST_SUITE(FirstSuite)
+
+BOOST_AUTO_TEST_CASE( TableMatchesGeomMapping )
+{
+  TemporaryFile geometry(kGeometryFileName, makeBarrelGeometry(kStripsInLayers));
+  {
+    SmallBarrel barrel;
+    const JPetParamBank& bank = barrel.manager.getParamBank();
+    StripPosTable table(*barrel.mapper, bank);
+    BOOST_REQUIRE_EQUAL(bank.getBarrelSlots().size(), 12u);
+    for (const auto& slot : bank.getBarrelSlots()) {
+      StripPos expected = barrel.mapper->getStripPos(*slot.second);
+      const StripPos& pos = table.getStripPos(*slot.second);
+      BOOST_REQUIRE(StripPosTable::isValid(pos));
+      BOOST_REQUIRE_EQUAL(pos.layer, expected.layer);
+      BOOST_REQUIRE_EQUAL(pos.slot, expected.slot);
+    }
+    for (const auto& pm : bank.getPMs()) {
+      StripPos expected =
+        barrel.mapper->getStripPos(pm.second->getBarrelSlot());
+      const StripPos& pos = table.getStripPos(*pm.second);
+      BOOST_REQUIRE_EQUAL(pos.layer, expected.layer);
+      BOOST_REQUIRE_EQUAL(pos.slot, expected.slot);
+    }
+  }
+}
+
+BOOST_AUTO_TEST_CASE( UnknownIdsAreInvalid )
+{
+  TemporaryFile geometry(kGeometryFileName, makeBarrelGeometry(kStripsInLayers));
+  {
+    SmallBarrel barrel;
+    StripPosTable table(*barrel.mapper, barrel.manager.getParamBank());
+    JPetBarrelSlot unknownSlot(1000, true, "unknown", 0., 1);
+    BOOST_REQUIRE(!StripPosTable::isValid(table.getStripPos(unknownSlot)));
+    JPetBarrelSlot negativeSlot(-1, true, "negative", 0., 1);
+    BOOST_REQUIRE(!StripPosTable::isValid(table.getStripPos(negativeSlot)));
+  }
+}
+
+BOOST_AUTO_TEST_CASE( StripsOfAllSlotsFitInLayerSizes )
+{
+  TemporaryFile geometry(kGeometryFileName, makeBarrelGeometry(kStripsInLayers));
+  {
+    SmallBarrel barrel;
+    const JPetParamBank& bank = barrel.manager.getParamBank();
+    StripPosTable table(*barrel.mapper, bank);
+    std::vector<size_t> layerSizes = barrel.mapper->getLayersSizes();
+    ScintillatorsInLayers selection;
+    for (const auto& slot : bank.getBarrelSlots()) {
+      const StripPos& pos = table.getStripPos(*slot.second);
+      BOOST_REQUIRE(pos.layer >= 1 && pos.layer <= layerSizes.size());
+      BOOST_REQUIRE(pos.slot >= 1 && pos.slot <= layerSizes[pos.layer - 1]);
+      selection.add(pos.layer, pos.slot);
+      BOOST_REQUIRE(selection.contains(pos.layer, pos.slot));
+    }
+    // every barrel slot is a separate strip
+    BOOST_REQUIRE_EQUAL(selection.size(), bank.getBarrelSlots().size());
+  }
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,88 @@
+#ifndef TESTHELPERS_H
+#define TESTHELPERS_H
+
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace jpet_event_display
+{
+/* File in the working directory which is removed, together with files derived
+   from it (event index, display cache), when it goes out of scope, so nothing
+   is left behind also when a test fails.
+*/
+class TemporaryFile
+{
+public:
+  // the file is only removed at the end, it is created by the tested code
+  explicit TemporaryFile(const std::string& fileName) : fFileNames{fileName} {}
+  TemporaryFile(const std::string& fileName, const std::string& content)
+    : fFileNames{fileName}
+  {
+    std::ofstream(fileName.c_str()) << content;
+  }
+  TemporaryFile(const TemporaryFile&) = delete;
+  TemporaryFile& operator=(const TemporaryFile&) = delete;
+  ~TemporaryFile()
+  {
+    for (const std::string& fileName : fFileNames)
+      std::remove(fileName.c_str());
+  }
+
+  const std::string& getName() const
+  {
+    return fFileNames.front();
+  }
+  void addDerivedFile(const std::string& fileName)
+  {
+    fFileNames.push_back(fileName);
+  }
+
+private:
+  std::vector<std::string> fFileNames;
+};
+
+/* Parameter file in the ASCII format of the framework for run 0: a layer of
+   radius 40 + 10 * i cm for each element of stripsInLayers, a barrel slot
+   and a scintillator per strip and two PMs per barrel slot.
+*/
+inline std::string makeBarrelGeometry(const std::vector<int>& stripsInLayers)
+{
+  std::ostringstream out, layers, slots, scins, pms;
+  int slotId = 1;
+  for (size_t layer = 0; layer < stripsInLayers.size(); layer++) {
+    layers << (layer ? ",\n" : "") << "{\"id\": " << layer + 1
+           << ", \"active\": true, \"name\": \"Layer" << layer + 1
+           << "\", \"radius\": " << 400 + 100 * layer << ", \"frame_id\": 1}";
+    for (int strip = 0; strip < stripsInLayers[layer]; strip++, slotId++) {
+      slots << (slotId > 1 ? ",\n" : "") << "{\"id\": " << slotId
+            << ", \"active\": true, \"name\": \"S" << slotId
+            << "\", \"theta1\": " << 360. * strip / stripsInLayers[layer]
+            << ", \"inFrameID\": " << strip + 1 << ", \"layer_id\": "
+            << layer + 1 << "}";
+      scins << (slotId > 1 ? ",\n" : "") << "{\"id\": " << slotId
+            << ", \"attenuation_length\": 0.0, \"length\": 500.0, "
+            << "\"width\": 19.0, \"height\": 7.0, \"barrelSlot_id\": "
+            << slotId << "}";
+      for (int side = 0; side < 2; side++)
+        pms << (slotId > 1 || side ? ",\n" : "") << "{\"id\": "
+            << 2 * slotId - 1 + side << ", \"is_right_side\": "
+            << (side ? "true" : "false") << ", \"description\": \"test\", "
+            << "\"scin_id\": " << slotId << ", \"barrelSlot_id\": " << slotId
+            << "}";
+    }
+  }
+  out << "{\"0\": {\n\"frame\": [{\"id\": 1, \"active\": true, "
+      << "\"status\": \"ok\", \"description\": \"test\", \"version\": 1, "
+      << "\"creator_id\": 1}],\n"
+      << "\"layer\": [\n" << layers.str() << "],\n"
+      << "\"barrelSlot\": [\n" << slots.str() << "],\n"
+      << "\"scin\": [\n" << scins.str() << "],\n"
+      << "\"PM\": [\n" << pms.str() << "]\n}}\n";
+  return out.str();
+}
+} // namespace jpet_event_display
+
+#endif /*  !TESTHELPERS_H */
@@ -0,0 +1,362 @@
+/**
+ *  @copyright Copyright 2016 The J-PET Framework Authors. All rights reserved.
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may find a copy of the License in the LICENCE file.
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *  @file SyntheticDataGenerator.cpp
+ *  @brief Writes parameter file of a configurable barrel and data files with
+ *  random time windows, for tests and benchmarks without real data.
+ */
+
+#include <JPetEvent/JPetEvent.h>
+#include <JPetHit/JPetHit.h>
+#include <JPetParamGetterAscii/JPetParamGetterAscii.h>
+#include <JPetParamManager/JPetParamManager.h>
+#include <JPetPhysSignal/JPetPhysSignal.h>
+#include <JPetRawSignal/JPetRawSignal.h>
+#include <JPetRecoSignal/JPetRecoSignal.h>
+#include <JPetSigCh/JPetSigCh.h>
+#include <JPetTimeWindow/JPetTimeWindow.h>
+#include <JPetWriter/JPetWriter.h>
+#include <TSystem.h>
+#include <boost/program_options.hpp>
+#include <cmath>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <random>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace
+{
+struct GeneratorOptions {
+  // geometry
+  std::string geometryFileName = "synthetic_barrel.json";
+  int runNumber = 0;
+  std::vector<unsigned int> stripsInLayers {48, 48, 96};
+  std::vector<double> radii {42.5, 46.75, 57.5}; // in cm
+  double scintillatorLength = 50.;               // in cm
+  // data
+  std::string dataFileName;
+  std::string objectType = "hit"; // sigch, raw, hit or event
+  long long numberOfTimeWindows = 1000;
+  unsigned int eventsPerTimeWindow = 10;
+  unsigned int multiplicity = 2; // hits in each event, only for event files
+  unsigned int numberOfThresholds = 4;
+  double maxFileSizeInMB = 0.; // 0 means no limit
+  unsigned int seed = 12345;
+};
+
+template <class T>
+std::vector<T> parseList(const std::string& list)
+{
+  std::vector<T> result;
+  std::istringstream in(list);
+  std::string item;
+  while (std::getline(in, item, ',')) {
+    std::istringstream value(item);
+    T number;
+    if (value >> number)
+      result.push_back(number);
+  }
+  return result;
+}
+
+/* Barrel in the layout of the ASCII parameter files of the framework: one
+   frame, layers with radii, barrel slots evenly distributed in theta, a
+   scintillator per slot and two photomultipliers (sides A and B) per
+   scintillator. Ids are consecutive in each table.
+*/
+bool writeGeometry(const GeneratorOptions& options)
+{
+  std::ofstream out(options.geometryFileName.c_str());
+  if (!out)
+    return false;
+  const size_t numberOfLayers = options.stripsInLayers.size();
+  std::ostringstream layers, slots, scins, pms;
+  int slotId = 1;
+  for (size_t layer = 0; layer < numberOfLayers; layer++) {
+    layers << (layer ? ",\n" : "") << "      {\"id\": " << layer + 1
+           << ", \"active\": true, \"name\": \"Layer" << layer + 1
+           << "\", \"radius\": " << options.radii[layer] * 10.
+           << ", \"frame_id\": 1}";
+    unsigned int strips = options.stripsInLayers[layer];
+    for (unsigned int strip = 0; strip < strips; strip++, slotId++) {
+      double theta = 360. * strip / strips;
+      slots << (slotId > 1 ? ",\n" : "") << "      {\"id\": " << slotId
+            << ", \"active\": true, \"name\": \"L" << layer + 1 << "S"
+            << strip + 1 << "\", \"theta1\": " << theta
+            << ", \"inFrameID\": " << strip + 1 << ", \"layer_id\": "
+            << layer + 1 << "}";
+      scins << (slotId > 1 ? ",\n" : "") << "      {\"id\": " << slotId
+            << ", \"attenuation_length\": 0.0, \"length\": "
+            << options.scintillatorLength * 10.
+            << ", \"width\": 19.0, \"height\": 7.0, \"barrelSlot_id\": "
+            << slotId << "}";
+      for (int side = 0; side < 2; side++) {
+        pms << (slotId > 1 || side ? ",\n" : "") << "      {\"id\": "
+            << 2 * slotId - 1 + side << ", \"is_right_side\": "
+            << (side ? "true" : "false") << ", \"description\": \"synthetic\""
+            << ", \"scin_id\": " << slotId << ", \"barrelSlot_id\": "
+            << slotId << "}";
+      }
+    }
+  }
+  out << "{\n  \"" << options.runNumber << "\": {\n"
+      << "    \"frame\": [\n      {\"id\": 1, \"active\": true, "
+      << "\"status\": \"ok\", \"description\": \"synthetic barrel\", "
+      << "\"version\": 1, \"creator_id\": 1}\n    ],\n"
+      << "    \"layer\": [\n" << layers.str() << "\n    ],\n"
+      << "    \"barrelSlot\": [\n" << slots.str() << "\n    ],\n"
+      << "    \"scin\": [\n" << scins.str() << "\n    ],\n"
+      << "    \"PM\": [\n" << pms.str() << "\n    ]\n"
+      << "  }\n}\n";
+  return static_cast<bool>(out);
+}
+
+// Objects with random content placed on strips of the parameter bank
+class ObjectFactory
+{
+public:
+  ObjectFactory(const JPetParamBank& bank, const GeneratorOptions& options)
+    : fOptions(options), fGenerator(options.seed)
+  {
+    for (const auto& pm : bank.getPMs()) {
+      fPMs.push_back(pm.second);
+      std::pair<const JPetPM*, const JPetPM*>& sides =
+        fSlotPMs[pm.second->getBarrelSlot().getID()];
+      (pm.second->getSide() == JPetPM::SideA ? sides.first : sides.second) =
+        pm.second;
+    }
+  }
+
+  bool isEmpty() const
+  {
+    return fPMs.size() < 2;
+  }
+
+  JPetSigCh makeSigCh(const JPetPM& pm, int threshold,
+                      JPetSigCh::EdgeType edge, double time)
+  {
+    JPetSigCh sigCh;
+    sigCh.setPM(pm);
+    sigCh.setThresholdNumber(threshold);
+    sigCh.setThreshold(80.f * threshold);
+    sigCh.setType(edge);
+    sigCh.setValue(time);
+    return sigCh;
+  }
+
+  // leading and trailing edge on each threshold, leading ones first in time
+  JPetRawSignal makeRawSignal(const JPetPM& pm, double time)
+  {
+    JPetRawSignal rawSignal;
+    std::uniform_real_distribution<double> width(2000., 8000.); // in ps
+    for (unsigned int i = 1; i <= fOptions.numberOfThresholds; i++) {
+      double leading = time + 100. * i;
+      rawSignal.addPoint(makeSigCh(pm, i, JPetSigCh::Leading, leading));
+      rawSignal.addPoint(makeSigCh(pm, i, JPetSigCh::Trailing,
+                                   leading + width(fGenerator) / i));
+    }
+    return rawSignal;
+  }
+
+  JPetPhysSignal makePhysSignal(const JPetPM& pm, double time)
+  {
+    JPetRecoSignal recoSignal;
+    recoSignal.setPM(pm);
+    recoSignal.setRawSignal(makeRawSignal(pm, time));
+    JPetPhysSignal physSignal;
+    physSignal.setPM(pm);
+    physSignal.setTime(time);
+    physSignal.setRecoSignal(recoSignal);
+    return physSignal;
+  }
+
+  // hit on a random strip, both signals come from its photomultipliers
+  JPetHit makeHit(double time)
+  {
+    const JPetPM& pm = randomPM();
+    const JPetBarrelSlot& slot = pm.getBarrelSlot();
+    const JPetPM& other = otherSide(pm);
+    double radius = slot.getLayer().getRadius() / 10.;
+    double theta = slot.getTheta() * M_PI / 180.;
+    std::uniform_real_distribution<double> z(-fOptions.scintillatorLength / 2.,
+        fOptions.scintillatorLength / 2.);
+    JPetHit hit;
+    hit.setBarrelSlot(slot);
+    hit.setScintillator(pm.getScin());
+    hit.setPos(radius * std::cos(theta), radius * std::sin(theta),
+               z(fGenerator));
+    hit.setTime(time);
+    bool sideA = pm.getSide() == JPetPM::SideA;
+    hit.setSignalA(makePhysSignal(sideA ? pm : other, time));
+    hit.setSignalB(makePhysSignal(sideA ? other : pm, time));
+    return hit;
+  }
+
+  const JPetPM& randomPM()
+  {
+    std::uniform_int_distribution<size_t> index(0, fPMs.size() - 1);
+    return *fPMs[index(fGenerator)];
+  }
+
+  void fillTimeWindow(JPetTimeWindow& timeWindow, double startTime)
+  {
+    const double eventSpacing = 20000.; // in ps
+    for (unsigned int i = 0; i < fOptions.eventsPerTimeWindow; i++) {
+      double time = startTime + i * eventSpacing;
+      if (fOptions.objectType == "sigch") {
+        timeWindow.add<JPetSigCh>(
+          makeSigCh(randomPM(), 1, JPetSigCh::Leading, time));
+      } else if (fOptions.objectType == "raw") {
+        timeWindow.add<JPetRawSignal>(makeRawSignal(randomPM(), time));
+      } else if (fOptions.objectType == "hit") {
+        timeWindow.add<JPetHit>(makeHit(time));
+      } else {
+        JPetEvent event;
+        for (unsigned int j = 0; j < fOptions.multiplicity; j++)
+          event.addHit(makeHit(time + 100. * j));
+        timeWindow.add<JPetEvent>(event);
+      }
+    }
+  }
+
+private:
+  // the same PM is returned for a barrel slot without the other side
+  const JPetPM& otherSide(const JPetPM& pm) const
+  {
+    auto sides = fSlotPMs.find(pm.getBarrelSlot().getID());
+    if (sides == fSlotPMs.end())
+      return pm;
+    const JPetPM* other = pm.getSide() == JPetPM::SideA ? sides->second.second
+                          : sides->second.first;
+    return other ? *other : pm;
+  }
+
+  const GeneratorOptions& fOptions;
+  std::mt19937_64 fGenerator;
+  std::vector<const JPetPM*> fPMs;
+  // PMs of sides A and B of each barrel slot, by id of the slot
+  std::map<int, std::pair<const JPetPM*, const JPetPM*>> fSlotPMs;
+};
+
+const std::map<std::string, std::string> kTimeWindowTypes = {
+  {"sigch", "JPetSigCh"},
+  {"raw", "JPetRawSignal"},
+  {"hit", "JPetHit"},
+  {"event", "JPetEvent"}
+};
+
+bool writeData(const GeneratorOptions& options, const JPetParamBank& bank)
+{
+  ObjectFactory factory(bank, options);
+  if (factory.isEmpty()) {
+    std::cerr << "No photomultipliers in parameter bank\n";
+    return false;
+  }
+  JPetWriter writer(options.dataFileName.c_str());
+  writer.writeObject(&bank, "ParamBank");
+  const char* type = kTimeWindowTypes.at(options.objectType).c_str();
+  const double timeWindowLength = 20000. * options.eventsPerTimeWindow;
+  const double maxFileSize = options.maxFileSizeInMB * 1024. * 1024.;
+  long long i = 0;
+  for (; i < options.numberOfTimeWindows; i++) {
+    JPetTimeWindow timeWindow(type);
+    factory.fillTimeWindow(timeWindow, i * timeWindowLength);
+    writer.write(timeWindow);
+    // baskets are flushed in large parts, size on disk is checked rarely
+    if (maxFileSize > 0. && i % 1000 == 999) {
+      FileStat_t stat;
+      if (gSystem->GetPathInfo(options.dataFileName.c_str(), stat) == 0 &&
+          stat.fSize >= maxFileSize)
+        break;
+    }
+  }
+  writer.closeFile();
+  std::cout << "Written " << i << " time windows of " << type << " to "
+            << options.dataFileName << "\n";
+  return true;
+}
+} // namespace
+
+int main(int argc, char** argv)
+{
+  namespace po = boost::program_options;
+  GeneratorOptions options;
+  std::string strips, radii;
+  try {
+    po::options_description desc("Allowed options");
+    desc.add_options()("help,h", "produce help message")(
+      "geometry,g", po::value(&options.geometryFileName),
+      "parameter file to write (or to use, if it exists)")(
+        "run,r", po::value(&options.runNumber), "run number in parameter file")(
+          "strips", po::value(&strips),
+          "comma separated numbers of strips in layers, e.g. 48,48,96")(
+            "radii", po::value(&radii),
+            "comma separated radii of layers in cm, e.g. 42.5,46.75,57.5")(
+              "length", po::value(&options.scintillatorLength),
+              "length of scintillators in cm")(
+                "data,d", po::value(&options.dataFileName),
+                "data file to write")(
+                  "type,t", po::value(&options.objectType),
+                  "objects in time windows: sigch, raw, hit or event")(
+                    "windows,w", po::value(&options.numberOfTimeWindows),
+                    "number of time windows")(
+                      "events,e", po::value(&options.eventsPerTimeWindow),
+                      "objects in each time window")(
+                        "multiplicity,m", po::value(&options.multiplicity),
+                        "hits in each event")(
+                          "thresholds", po::value(&options.numberOfThresholds),
+                          "thresholds of each raw signal (1-4)")(
+                            "max-size", po::value(&options.maxFileSizeInMB),
+                            "stop when data file reaches size in MB")(
+                              "seed", po::value(&options.seed),
+                              "seed of random generator");
+    po::variables_map vm;
+    po::store(po::parse_command_line(argc, argv, desc), vm);
+    po::notify(vm);
+    if (vm.count("help")) {
+      std::cout << desc << "\n";
+      return 1;
+    }
+    if (!strips.empty())
+      options.stripsInLayers = parseList<unsigned int>(strips);
+    if (!radii.empty())
+      options.radii = parseList<double>(radii);
+    if (options.stripsInLayers.empty() ||
+        options.stripsInLayers.size() != options.radii.size())
+      throw std::invalid_argument("need one radius for each layer");
+    if (kTimeWindowTypes.find(options.objectType) == kTimeWindowTypes.end())
+      throw std::invalid_argument("unknown object type: " + options.objectType);
+    if (options.numberOfThresholds < 1 || options.numberOfThresholds > 4)
+      throw std::invalid_argument("number of thresholds has to be 1-4");
+  } catch (std::exception& e) {
+    std::cerr << e.what() << "\n";
+    return 1;
+  }
+
+  if (gSystem->AccessPathName(options.geometryFileName.c_str())) {
+    if (!writeGeometry(options)) {
+      std::cerr << "Could not write " << options.geometryFileName << "\n";
+      return 1;
+    }
+    std::cout << "Written geometry to " << options.geometryFileName << "\n";
+  }
+  if (options.dataFileName.empty())
+    return 0;
+  JPetParamManager paramManager(
+    new JPetParamGetterAscii(options.geometryFileName));
+  paramManager.fillParameterBank(options.runNumber);
+  return writeData(options, paramManager.getParamBank()) ? 0 : 1;
+}